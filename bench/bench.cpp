@@ -0,0 +1,635 @@
+// Headless benchmarks for the gapi hot paths. Runs on an EGL context without a window, which is Mesa
+// llvmpipe on CPU-only CI machines, and prints one JSON document to stdout or to --out <file>.
+// --filter <text> runs only the groups whose name contains text.
+
+#include "gapi_renderer.hpp"
+#include "gapi_mesh.hpp"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+namespace{
+
+    using bench_clock = std::chrono::steady_clock;
+
+    struct bench_vertex{
+        glm::vec3 position;
+    };
+
+    using bench_layout = gapi::static_layout<bench_vertex, GAPI_FIELD(bench_vertex, position)>;
+
+    const char* BENCH_SHADER = R"(
+#type vertex
+layout(location = 0) in vec3 a_position;
+uniform mat4 u_transform;
+void main(){ gl_Position = u_transform * vec4(a_position, 1.0); }
+#type fragment
+out vec4 o_color;
+uniform vec4 u_color;
+uniform float u_scale;
+void main(){
+#ifdef VARIANT
+    o_color = u_color * u_scale * float(VARIANT);
+#else
+    o_color = u_color * u_scale;
+#endif
+}
+)";
+
+    template<typename Fn>
+    double measure_ms(Fn&& fn){
+        const auto start = bench_clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+    }
+
+    std::string escape(std::string_view str){
+        std::string out;
+        out.reserve(str.size());
+        for(char c : str){
+            if(c == '"' || c == '\\') out += '\\';
+            out += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+        }
+        return out;
+    }
+
+    class report{
+
+        public:
+            using metrics = std::vector<std::pair<std::string, double>>;
+
+            void add(std::string name, uint64_t iterations, double ms, metrics extra = {}){
+                m_results.push_back({std::move(name), iterations, ms, std::move(extra)});
+                std::cerr << m_results.back().name << ": " << ms << " ms\n";
+            }
+
+            void write(std::ostream& out, const ggl::info& info) const {
+                out << "{\n  \"schema\": 1,\n";
+                out << "  \"gl\": {\"vendor\": \"" << escape(info.vendor()) << "\", \"renderer\": \"" << escape(info.renderer())
+                    << "\", \"version\": \"" << escape(info.version()) << "\"},\n";
+                out << "  \"results\": [";
+                for(size_t i = 0; i < m_results.size(); i++){
+                    const auto& r = m_results[i];
+                    out << (i ? ",\n" : "\n") << "    {\"name\": \"" << escape(r.name) << "\", \"iterations\": " << r.iterations
+                        << ", \"ms\": " << r.ms << ", \"us_per_iteration\": " << (r.iterations ? r.ms * 1000.0 / r.iterations : 0.0);
+                    for(const auto& [key, value] : r.extra) out << ", \"" << escape(key) << "\": " << value;
+                    out << "}";
+                }
+                out << "\n  ]\n}\n";
+            }
+
+        private:
+            struct result{
+                std::string name;
+                uint64_t iterations;
+                double ms;
+                metrics extra;
+            };
+
+            std::vector<result> m_results{};
+    };
+
+    class headless_context{
+
+        public:
+            ~headless_context(){
+                if(m_display == EGL_NO_DISPLAY) return;
+                eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                if(m_surface != EGL_NO_SURFACE) eglDestroySurface(m_display, m_surface);
+                if(m_context != EGL_NO_CONTEXT) eglDestroyContext(m_display, m_context);
+                eglTerminate(m_display);
+            }
+
+            bool init(){
+                auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+                if(get_platform_display) m_display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if(m_display == EGL_NO_DISPLAY) m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+                EGLint major = 0, minor = 0;
+                if(m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, &major, &minor) || !eglBindAPI(EGL_OPENGL_API)) return false;
+
+                // The surfaceless platform has no pbuffer configs; any config works with EGL_NO_SURFACE there.
+                EGLConfig config{};
+                EGLint count = 0;
+                for(EGLint surface_type : {EGL_PBUFFER_BIT, 0}){
+                    const EGLint attributes[] = {EGL_SURFACE_TYPE, surface_type, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_NONE};
+                    if(eglChooseConfig(m_display, attributes, &config, 1, &count) && count > 0){
+                        m_pbuffer = surface_type != 0;
+                        break;
+                    }
+                }
+                if(count == 0) return false;
+
+                for(EGLint minor_version : {5, 3}){
+                    const EGLint attributes[] = {EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, minor_version,
+                                                 EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE};
+                    m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, attributes);
+                    if(m_context != EGL_NO_CONTEXT) break;
+                }
+                if(m_context == EGL_NO_CONTEXT) return false;
+
+                if(m_pbuffer){
+                    const EGLint attributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+                    m_surface = eglCreatePbufferSurface(m_display, config, attributes);
+                }
+                return eglMakeCurrent(m_display, m_surface, m_surface, m_context) == EGL_TRUE;
+            }
+
+        private:
+            EGLDisplay m_display{EGL_NO_DISPLAY};
+            EGLContext m_context{EGL_NO_CONTEXT};
+            EGLSurface m_surface{EGL_NO_SURFACE};
+            bool m_pbuffer{false};
+    };
+
+    // Draws land in an offscreen target so the default framebuffer of a surfaceless context is never touched.
+    class render_target{
+
+        public:
+            render_target(int32_t width, int32_t height){
+                glGenFramebuffers(1, &m_fbo);
+                glGenRenderbuffers(2, m_attachments);
+                glBindRenderbuffer(GL_RENDERBUFFER, m_attachments[0]);
+                glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+                glBindRenderbuffer(GL_RENDERBUFFER, m_attachments[1]);
+                glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+                glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_attachments[0]);
+                glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_attachments[1]);
+                glViewport(0, 0, width, height);
+            }
+
+            ~render_target(){
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                glDeleteRenderbuffers(2, m_attachments);
+                glDeleteFramebuffers(1, &m_fbo);
+            }
+
+            [[nodiscard]] bool complete() const { return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE; }
+
+        private:
+            uint32_t m_fbo{0};
+            uint32_t m_attachments[2]{};
+    };
+
+    struct bench_env{
+        ggl::info& info;
+        ggl::shader_preprocessor& preprocessor;
+        std::filesystem::path scratch;
+        report& out;
+    };
+
+    std::shared_ptr<ggl::shader> make_bench_shader(bench_env& env, const std::string& name, const ggl::shader_defines& defines = {}){
+        return std::make_shared<ggl::shader>(name, env.preprocessor.process_source(BENCH_SHADER, defines));
+    }
+
+    std::shared_ptr<ggl::vertex_array> make_quad(float x, float y, float size){
+        const bench_vertex vertices[4] = {{{x, y, 0.0f}}, {{x + size, y, 0.0f}}, {{x + size, y + size, 0.0f}}, {{x, y + size, 0.0f}}};
+        const uint32_t indices[6] = {0, 1, 2, 2, 3, 0};
+
+        auto vb = ggl::make_vertex(vertices, sizeof(vertices), ggl::DRAW_STATIC);
+        vb->configure_layout(bench_layout::layout());
+        auto va = ggl::make_array();
+        va->emplace_vertex(vb);
+        va->emplace_index(ggl::make_index(indices, 6, 4, ggl::DRAW_STATIC));
+        return va;
+    }
+
+    // Sort-plus-dispatch through gapi_render, reported per 10k packets, over N distinct VAOs.
+    void bench_submit(bench_env& env){
+        constexpr uint32_t PACKETS = 10000;
+        constexpr uint32_t FRAMES = 20;
+        auto program = make_bench_shader(env, "submit");
+        program->bind();
+        program->uniform("u_transform", glm::mat4(1.0f));
+        program->uniform("u_color", glm::vec4(1.0f));
+        program->uniform("u_scale", 1.0f);
+
+        for(uint32_t vaos : {64u, 1024u, 4096u}){
+            std::vector<std::shared_ptr<ggl::vertex_array>> arrays;
+            arrays.reserve(vaos);
+            for(uint32_t i = 0; i < vaos; i++) arrays.push_back(make_quad(-1.0f + 2.0f * (i % 64) / 64.0f, -1.0f + 2.0f * (i / 64 % 64) / 64.0f, 0.02f));
+
+            gapir::gl_renderer renderer;
+            renderer.init();
+            std::mt19937 rng(vaos);
+            std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+
+            double submit_ms = 0.0, flush_ms = 0.0;
+            for(uint32_t frame = 0; frame < FRAMES; frame++){
+                submit_ms += measure_ms([&]{
+                    for(uint32_t i = 0; i < PACKETS; i++){
+                        gapir::draw_state state{};
+                        state.program = program.get();
+                        state.depth = depth(rng);
+                        renderer.submit(arrays[i % vaos], state);
+                    }
+                });
+                flush_ms += measure_ms([&]{
+                    renderer.end_frame();
+                    glFinish();
+                });
+            }
+
+            const std::string suffix = std::to_string(vaos) + "_vaos";
+            env.out.add("submit.queue_" + suffix, uint64_t(PACKETS) * FRAMES, submit_ms);
+            env.out.add("submit.sort_dispatch_" + suffix, FRAMES, flush_ms, {{"ms_per_10k_packets", flush_ms / FRAMES * 10000.0 / PACKETS}});
+        }
+    }
+
+    // The same meshes drawn from one geometry pool through multi-draw-indirect versus one VAO each.
+    void bench_multi_draw(bench_env& env){
+        constexpr uint32_t MESHES = 2048;
+        constexpr uint32_t FRAMES = 20;
+        auto program = make_bench_shader(env, "multi_draw");
+        program->bind();
+        program->uniform("u_transform", glm::mat4(1.0f));
+        program->uniform("u_color", glm::vec4(1.0f));
+        program->uniform("u_scale", 1.0f);
+
+        ggl::geometry_pool pool(bench_layout::layout(), MESHES * 4, MESHES * 6);
+        std::vector<ggl::geometry_pool::mesh> meshes;
+        std::vector<std::shared_ptr<ggl::vertex_array>> arrays;
+        for(uint32_t i = 0; i < MESHES; i++){
+            const float x = -1.0f + 2.0f * (i % 64) / 64.0f, y = -1.0f + 2.0f * (i / 64 % 64) / 64.0f, size = 0.02f;
+            const bench_vertex vertices[4] = {{{x, y, 0.0f}}, {{x + size, y, 0.0f}}, {{x + size, y + size, 0.0f}}, {{x, y + size, 0.0f}}};
+            const uint32_t indices[6] = {0, 1, 2, 2, 3, 0};
+            meshes.push_back(pool.allocate(vertices, 4, indices, 6));
+            arrays.push_back(make_quad(x, y, size));
+        }
+
+        gapir::gl_renderer renderer;
+        renderer.init();
+
+        const double per_vao = measure_ms([&]{
+            for(uint32_t frame = 0; frame < FRAMES; frame++){
+                for(auto& va : arrays) renderer.submit(va, {program.get()});
+                renderer.end_frame();
+                glFinish();
+            }
+        });
+
+        const double pooled = measure_ms([&]{
+            for(uint32_t frame = 0; frame < FRAMES; frame++){
+                for(auto& m : meshes){
+                    gapir::draw_state state{program.get()};
+                    state.range = m.range();
+                    renderer.submit(pool.array(), state);
+                }
+                renderer.end_frame();
+                glFinish();
+            }
+        });
+
+        env.out.add("multi_draw.per_vao", FRAMES, per_vao, {{"meshes", MESHES}});
+        env.out.add("multi_draw.pool_indirect", FRAMES, pooled, {{"meshes", MESHES}, {"mdi", GLEW_ARB_multi_draw_indirect ? 1.0 : 0.0}});
+    }
+
+    // Values change every call so the redundant-set filter never short-circuits.
+    void bench_uniforms(bench_env& env){
+        constexpr uint32_t SETS = 100000;
+        auto program = make_bench_shader(env, "uniforms");
+        program->bind();
+
+        const auto color = program->handle("u_color");
+        const auto transform = program->handle("u_transform");
+        const int32_t color_location = static_cast<int32_t>(program->uniformloc("u_color"));
+
+        const double by_name = measure_ms([&]{
+            for(uint32_t i = 0; i < SETS; i++) program->uniform("u_color", glm::vec4(float(i)));
+        });
+        const double by_handle = measure_ms([&]{
+            for(uint32_t i = 0; i < SETS; i++) program->uniform(color, glm::vec4(float(i)));
+        });
+        const double by_location = measure_ms([&]{
+            for(uint32_t i = 0; i < SETS; i++){
+                const auto v = glm::vec4(float(i));
+                glUniform4fv(color_location, 1, glm::value_ptr(v));
+            }
+        });
+        const double mat4_by_handle = measure_ms([&]{
+            for(uint32_t i = 0; i < SETS; i++) program->uniform(transform, glm::mat4(float(i)));
+        });
+        const double redundant = measure_ms([&]{
+            for(uint32_t i = 0; i < SETS; i++) program->uniform(color, glm::vec4(1.0f));
+        });
+        glFinish();
+
+        env.out.add("uniforms.vec4_by_name", SETS, by_name);
+        env.out.add("uniforms.vec4_by_handle", SETS, by_handle);
+        env.out.add("uniforms.vec4_raw_location", SETS, by_location);
+        env.out.add("uniforms.mat4_by_handle", SETS, mat4_by_handle);
+        env.out.add("uniforms.vec4_redundant", SETS, redundant);
+    }
+
+    void bench_buffers(bench_env& env){
+        for(size_t size : {size_t(4) << 10, size_t(64) << 10, size_t(1) << 20, size_t(16) << 20}){
+            std::vector<uint8_t> data(size, 0x5A);
+            const uint32_t iterations = static_cast<uint32_t>(std::clamp<size_t>((size_t(256) << 20) / size, 8, 4096));
+
+            const double create = measure_ms([&]{
+                for(uint32_t i = 0; i < iterations; i++){
+                    auto vb = ggl::make_vertex(data.data(), static_cast<uint32_t>(size), ggl::DRAW_STATIC);
+                }
+                glFinish();
+            });
+
+            auto dynamic = ggl::make_vertex(data.data(), static_cast<uint32_t>(size), ggl::DRAW_DYNAMIC);
+            const double update = measure_ms([&]{
+                for(uint32_t i = 0; i < iterations; i++){
+                    dynamic->update(0, std::as_bytes(std::span(data)));
+                    dynamic->flush();
+                }
+                glFinish();
+            });
+
+            const std::string suffix = std::to_string(size >> 10) + "KB";
+            const double megabytes = double(size) * iterations / (1 << 20);
+            env.out.add("buffers.create_upload_" + suffix, iterations, create, {{"mb_per_s", megabytes / (create / 1000.0)}});
+            env.out.add("buffers.update_flush_" + suffix, iterations, update, {{"mb_per_s", megabytes / (update / 1000.0)}});
+        }
+    }
+
+    // Uncompressed 32-bit TGA, which stb_image reads without any encoder on our side.
+    std::filesystem::path write_tga(const std::filesystem::path& path, int32_t width, int32_t height){
+        std::vector<uint8_t> file(18 + size_t(width) * height * 4);
+        file[2] = 2;
+        file[12] = static_cast<uint8_t>(width & 0xFF);
+        file[13] = static_cast<uint8_t>(width >> 8);
+        file[14] = static_cast<uint8_t>(height & 0xFF);
+        file[15] = static_cast<uint8_t>(height >> 8);
+        file[16] = 32;
+        file[17] = 0x28;
+
+        std::mt19937 rng(7);
+        for(size_t i = 18; i < file.size(); i++) file[i] = static_cast<uint8_t>(rng());
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+        return path;
+    }
+
+    void bench_textures(bench_env& env){
+        constexpr uint32_t ITERATIONS = 8;
+        const auto path = write_tga(env.scratch / "bench.tga", 1024, 1024);
+
+        const double decode = measure_ms([&]{
+            for(uint32_t i = 0; i < ITERATIONS; i++) auto image = ggl::decode_image(path);
+        });
+
+        double upload = 0.0;
+        for(uint32_t i = 0; i < ITERATIONS; i++){
+            auto image = ggl::decode_image(path);
+            ggl::texture_2d texture(ggl::TEX_FILTER_LINEAR, ggl::TEX_WRAP_CLAMP);
+            upload += measure_ms([&]{
+                texture.upload(std::move(image));
+                glFinish();
+            });
+        }
+
+        for(auto [name, filter] : {std::pair{"linear", ggl::TEX_FILTER_LINEAR}, std::pair{"mipmapped", ggl::TEX_FILTER_LINEAR_MIPMAP}}){
+            const double load = measure_ms([&]{
+                for(uint32_t i = 0; i < ITERATIONS; i++){
+                    ggl::texture_2d texture(path, filter, ggl::TEX_WRAP_CLAMP);
+                    glFinish();
+                }
+            });
+            env.out.add(std::string("textures.load_1024_") + name, ITERATIONS, load);
+        }
+
+        env.out.add("textures.decode_1024", ITERATIONS, decode);
+        env.out.add("textures.upload_1024", ITERATIONS, upload);
+    }
+
+    // CPU SIMD chain versus the scalar reference and the driver's glGenerateMipmap.
+    void bench_mipmaps(bench_env& env){
+        constexpr int32_t SIZE = 2048;
+        constexpr uint32_t ITERATIONS = 4;
+        std::vector<uint8_t> pixels(size_t(SIZE) * SIZE * 4);
+        std::mt19937 rng(11);
+        for(auto& p : pixels) p = static_cast<uint8_t>(rng());
+
+        const double simd = measure_ms([&]{
+            for(uint32_t i = 0; i < ITERATIONS; i++) auto chain = gmip::build_chain(pixels.data(), SIZE, SIZE, 4);
+        });
+
+        gapi::thread_pool pool;
+        gmip::options threaded{};
+        threaded.pool = &pool;
+        const double parallel = measure_ms([&]{
+            for(uint32_t i = 0; i < ITERATIONS; i++) auto chain = gmip::build_chain(pixels.data(), SIZE, SIZE, 4, threaded);
+        });
+
+        gmip::options srgb{};
+        srgb.srgb = true;
+        const double gamma = measure_ms([&]{
+            for(uint32_t i = 0; i < ITERATIONS; i++) auto chain = gmip::build_chain(pixels.data(), SIZE, SIZE, 4, srgb);
+        });
+
+        const double scalar = measure_ms([&]{
+            for(uint32_t i = 0; i < ITERATIONS; i++){
+                std::vector<uint8_t> src = pixels, dst;
+                for(int32_t w = SIZE, h = SIZE; w > 1 || h > 1; w = std::max(1, w / 2), h = std::max(1, h / 2)){
+                    dst.resize(size_t(std::max(1, w / 2)) * std::max(1, h / 2) * 4);
+                    gmip::downsample_reference(src.data(), w, h, 4, dst.data(), false);
+                    src.swap(dst);
+                }
+            }
+        });
+
+        uint32_t texture = 0;
+        glGenTextures(1, &texture);
+        ggl::state_cache::current().bind_texture(0, ggl::TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, SIZE, SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glFinish();
+        const double driver = measure_ms([&]{
+            for(uint32_t i = 0; i < ITERATIONS; i++){
+                glGenerateMipmap(GL_TEXTURE_2D);
+                glFinish();
+            }
+        });
+        ggl::state_cache::current().release_texture(texture);
+        glDeleteTextures(1, &texture);
+
+        env.out.add("mipmaps.simd_2048", ITERATIONS, simd);
+        env.out.add("mipmaps.simd_threaded_2048", ITERATIONS, parallel, {{"threads", double(pool.size() + 1)}});
+        env.out.add("mipmaps.srgb_2048", ITERATIONS, gamma);
+        env.out.add("mipmaps.scalar_reference_2048", ITERATIONS, scalar);
+        env.out.add("mipmaps.gl_generate_mipmap_2048", ITERATIONS, driver);
+    }
+
+    // Every program gets its own VARIANT define so neither gapi nor the driver can share work between them.
+    void bench_shaders(bench_env& env){
+        constexpr uint32_t PROGRAMS = 32;
+
+        const double sync = measure_ms([&]{
+            for(uint32_t i = 0; i < PROGRAMS; i++) auto program = make_bench_shader(env, "sync", {{"VARIANT", std::to_string(i + 1)}});
+        });
+
+        const double deferred = measure_ms([&]{
+            gapi::shader_container container;
+            for(uint32_t i = 0; i < PROGRAMS; i++){
+                auto sources = env.preprocessor.process_source(BENCH_SHADER, {{"VARIANT", std::to_string(PROGRAMS + i + 1)}});
+                auto program = container.load<ggl::shader>("deferred_" + std::to_string(i), std::move(sources), ggl::SHADER_BUILD::DEFERRED);
+            }
+            while(container.pending() > 0) std::this_thread::yield();
+        });
+
+        env.out.add("shaders.compile_link", PROGRAMS, sync);
+        env.out.add("shaders.compile_link_deferred", PROGRAMS, deferred, {{"parallel_compile", GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile ? 1.0 : 0.0}});
+
+        ggl::program_cache cache(env.scratch / "programs", env.info);
+        cache.clear();
+        ggl::program_cache::make_current(&cache);
+
+        const double cold = measure_ms([&]{
+            for(uint32_t i = 0; i < PROGRAMS; i++) auto program = make_bench_shader(env, "cached", {{"VARIANT", std::to_string(2 * PROGRAMS + i + 1)}});
+        });
+        const auto cold_stats = cache.stats();
+        cache.reset_stats();
+
+        const double warm = measure_ms([&]{
+            for(uint32_t i = 0; i < PROGRAMS; i++) auto program = make_bench_shader(env, "cached", {{"VARIANT", std::to_string(2 * PROGRAMS + i + 1)}});
+        });
+        const auto warm_stats = cache.stats();
+        ggl::program_cache::make_current(nullptr);
+
+        env.out.add("program_cache.cold", PROGRAMS, cold, {{"enabled", cache.enabled() ? 1.0 : 0.0}, {"hits", cold_stats.hits}, {"misses", cold_stats.misses}});
+        env.out.add("program_cache.warm", PROGRAMS, warm, {{"hits", warm_stats.hits}, {"misses", warm_stats.misses}, {"rejected", warm_stats.rejected}});
+    }
+
+    void bench_layouts(bench_env& env){
+        constexpr uint32_t ITERATIONS = 1000000;
+        volatile uint32_t sink = 0;
+
+        const double dynamic = measure_ms([&]{
+            for(uint32_t i = 0; i < ITERATIONS; i++){
+                gapi::buffer_layout layout{{"a_position", gapi::XYZ, gapi::F3}, {"a_normal", gapi::XYZ, gapi::F3}, {"a_uv", gapi::UV, gapi::F2}};
+                sink = sink + layout.stride();
+            }
+        });
+
+        const double derived = measure_ms([&]{
+            for(uint32_t i = 0; i < ITERATIONS; i++){
+                gapi::buffer_layout layout = bench_layout::layout();
+                sink = sink + layout.stride();
+            }
+        });
+
+        env.out.add("buffer_layout.initializer_list", ITERATIONS, dynamic);
+        env.out.add("buffer_layout.static_layout", ITERATIONS, derived);
+    }
+
+    // A shuffled grid is the worst case for the post-transform cache; report cache metrics before and after.
+    void bench_mesh(bench_env& env){
+        constexpr uint32_t GRID = 256;
+        std::vector<bench_vertex> vertices;
+        vertices.reserve(size_t(GRID + 1) * (GRID + 1));
+        for(uint32_t y = 0; y <= GRID; y++)
+            for(uint32_t x = 0; x <= GRID; x++) vertices.push_back({{float(x), float(y), 0.0f}});
+
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for(uint32_t y = 0; y < GRID; y++){
+            for(uint32_t x = 0; x < GRID; x++){
+                const uint32_t i = y * (GRID + 1) + x;
+                triangles.push_back({i, i + 1, i + GRID + 2});
+                triangles.push_back({i, i + GRID + 2, i + GRID + 1});
+            }
+        }
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(3));
+        std::vector<uint32_t> indices;
+        for(auto& t : triangles) indices.insert(indices.end(), t.begin(), t.end());
+
+        const auto count = static_cast<uint32_t>(indices.size());
+        const auto before = gmesh::analyze_vertex_cache(indices.data(), count, static_cast<uint32_t>(vertices.size()));
+        gmesh::mesh_data optimized{};
+        const double ms = measure_ms([&]{
+            optimized = gmesh::optimize(vertices.data(), static_cast<uint32_t>(vertices.size()), sizeof(bench_vertex), indices.data(), count);
+        });
+        const auto after = gmesh::analyze_vertex_cache(optimized.indices.data(), static_cast<uint32_t>(optimized.indices.size()), optimized.vertex_count);
+
+        env.out.add("mesh.optimize_256_grid", 1, ms, {{"triangles", count / 3.0}, {"acmr_before", before.acmr}, {"acmr_after", after.acmr},
+                                                      {"atvr_before", before.atvr}, {"atvr_after", after.atvr}});
+    }
+}
+
+int main(int argc, char** argv){
+    std::string out_path, filter;
+    for(int i = 1; i < argc; i++){
+        const std::string_view arg = argv[i];
+        if(arg == "--out" && i + 1 < argc) out_path = argv[++i];
+        else if(arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else{
+            std::cerr << "usage: gapi_bench [--out file.json] [--filter group]\n";
+            return 2;
+        }
+    }
+
+    // Mesa's on-disk shader cache would turn every compile after the first run into a cache hit.
+#ifndef _WIN32
+    setenv("MESA_SHADER_CACHE_DISABLE", "true", 0);
+#endif
+
+    headless_context egl;
+    if(!egl.init()){
+        std::cerr << "Failed to create a headless EGL context\n";
+        return 1;
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum status = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // A GLX build of GLEW still loads every core and extension entry point before it looks for a GLX display.
+    if(status == GLEW_ERROR_NO_GLX_DISPLAY) status = GLEW_OK;
+#endif
+    if(status != GLEW_OK){
+        std::cerr << "Failed to initialize GLEW: " << glewGetErrorString(status) << '\n';
+        return 1;
+    }
+
+    ggl::state_cache state;
+    ggl::state_cache::make_current(&state);
+    ggl::info info;
+    ggl::shader_preprocessor preprocessor(info);
+
+    render_target target(256, 256);
+    if(!target.complete()){
+        std::cerr << "Offscreen framebuffer is incomplete\n";
+        return 1;
+    }
+
+    const auto scratch = std::filesystem::temp_directory_path() / "gapi_bench";
+    std::filesystem::create_directories(scratch);
+
+    report results;
+    bench_env env{info, preprocessor, scratch, results};
+    const std::pair<const char*, void(*)(bench_env&)> groups[] = {
+        {"submit", bench_submit},
+        {"multi_draw", bench_multi_draw},
+        {"uniforms", bench_uniforms},
+        {"buffers", bench_buffers},
+        {"textures", bench_textures},
+        {"mipmaps", bench_mipmaps},
+        {"shaders", bench_shaders},
+        {"buffer_layout", bench_layouts},
+        {"mesh", bench_mesh},
+    };
+
+    for(auto& [name, run] : groups){
+        if(filter.empty() || std::string_view(name).find(filter) != std::string_view::npos) run(env);
+    }
+
+    if(out_path.empty()) results.write(std::cout, info);
+    else{
+        std::ofstream file(out_path);
+        results.write(file, info);
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(scratch, error);
+    return 0;
+}
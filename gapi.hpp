@@ -3,8 +3,11 @@
 #include <memory>
 #include <type_traits>
 #include <string>
+#include <string_view>
+#include <cstring>
 #include <initializer_list>
 #include <vector>
+#include <span>
 #include <algorithm>
 #include <cassert>
 #include <unordered_map>
@@ -16,7 +19,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/vector_angle.hpp>
 
-#include <unordered_map>
+#include <array>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
@@ -43,16 +46,15 @@
 #define GAPI_PLATFORM_ANDROID
 #elif defined(__linux__)
 #define GAPI_PLATFORM_LINUX
-__attribute__((visibility("default")))
 #else
 #error "Unknown platform!"
 #endif
 
 #ifdef _DEBUG
 #include <iostream>
+#define gapi_debug_msg(cap, msg) std::cerr << cap << msg << "\n"
 #if defined(GAPI_PLATFORM_WINDOWS)
 #define gapi_debugbreak() __debugbreak()
-#define gapi_debug_msg(cap, msg) std::cerr << cap << msg << "\n"
 #elif defined(GAPI_PLATFORM_LINUX)
 #include <signal.h>
 #define gapi_debugbreak() raise(SIGTRAP)
@@ -74,7 +76,8 @@ namespace gapi{
     enum COMPOENENT : int32_t{
         XYZ     = 3,    XYZW    = 4,
         RGB     = 3,    RGBA    = 4,
-        XY      = 2,    UV      = 2,    NONE    = 0,
+        XY      = 2,    UV      = 2,    X       = 1,
+        NONE    = 0,
     };
 
     enum DATA : uint32_t{
@@ -84,10 +87,53 @@ namespace gapi{
         UI4     = 16,   MAT2    = 16,   MAT3    = 36,   MAT4    = 64  
     };
 
+    enum ATTRIBUTE : uint32_t{
+        ATTRIB_FLOAT,   ATTRIB_HALF,    ATTRIB_BYTE,    ATTRIB_UBYTE,
+        ATTRIB_SHORT,   ATTRIB_USHORT,  ATTRIB_INT,     ATTRIB_UINT,
+        ATTRIB_INT_2_10_10_10,          ATTRIB_UINT_2_10_10_10
+    };
+
+    [[nodiscard]] constexpr uint32_t attribute_size(ATTRIBUTE type, uint32_t component) noexcept {
+        switch(type){
+            case ATTRIB_HALF: case ATTRIB_SHORT: case ATTRIB_USHORT:    return 2 * component;
+            case ATTRIB_BYTE: case ATTRIB_UBYTE:                        return component;
+            case ATTRIB_INT_2_10_10_10: case ATTRIB_UINT_2_10_10_10:    return 4;
+            default:                                                    return 4 * component;
+        }
+    }
+
     enum class GAPI : uint32_t{
         SYSTEM = 0, OPENGL = 1, DIRECTX = 2, VULKAN = 3, METAL = 4
     };
 
+    [[nodiscard]] constexpr uint32_t hash(std::string_view str) noexcept {
+        uint32_t value = 2166136261u;
+        for(char c : str){
+            value ^= static_cast<uint8_t>(c);
+            value *= 16777619u;
+        }
+        return value;
+    }
+
+    [[nodiscard]] constexpr uint64_t hash64(std::string_view str, uint64_t value = 14695981039346656037ull) noexcept {
+        for(char c : str){
+            value ^= static_cast<uint8_t>(c);
+            value *= 1099511628211ull;
+        }
+        return value;
+    }
+
+    namespace literals{
+        [[nodiscard]] constexpr uint32_t operator""_hash(const char* str, size_t length) noexcept {
+            return hash(std::string_view(str, length));
+        }
+    }
+
+    struct uniform_handle{
+        int32_t index{-1};
+        [[nodiscard]] constexpr bool valid() const { return index >= 0; }
+    };
+
 
     class info {
 
@@ -117,38 +163,50 @@ namespace gapi{
     };
 
     struct buffer_elements{
-        buffer_elements() {}
-        buffer_elements(const std::string& name, COMPOENENT comp, uint32_t size, bool normalized = false) noexcept
-            : name(name), component(comp), size(size), normalized(normalized) {}
-        ~buffer_elements() = default;
-
-        std::string name{};
+        constexpr buffer_elements() {}
+        constexpr buffer_elements(std::string_view name, COMPOENENT comp, uint32_t size, bool normalized = false, uint32_t divisor = 0) noexcept
+            : name(name), component(comp), size(size), normalized(normalized), divisor(divisor) {}
+        constexpr buffer_elements(std::string_view name, ATTRIBUTE type, COMPOENENT comp, bool normalized = false, bool integer = false, uint32_t divisor = 0) noexcept
+            : name(name), type(type), component(comp), size(attribute_size(type, comp)), normalized(normalized), integer(integer), divisor(divisor) {}
+        constexpr ~buffer_elements() = default;
+
+        std::string_view name{};
+        ATTRIBUTE type{ATTRIB_FLOAT};
         COMPOENENT component{COMPOENENT::NONE};
         uint32_t size{0};
         uint32_t offset{0}; 
         bool normalized{false};
+        bool integer{false};
+        uint32_t divisor{0};
     };
 
     class buffer_layout{
         public:
             buffer_layout(){}
             buffer_layout(std::initializer_list<buffer_elements> elements)
-                : m_elements(elements) { _stride(); }
+                : m_storage(elements) { m_elements = m_storage; _stride(); }
+            buffer_layout(std::span<const buffer_elements> elements, uint32_t stride)
+                : m_elements(elements), m_stride(stride) {}
+            buffer_layout(const buffer_layout& other) { *this = other; }
+            buffer_layout& operator=(const buffer_layout& other){
+                m_storage = other.m_storage;
+                m_elements = other.m_storage.empty() ? other.m_elements : std::span<const buffer_elements>(m_storage);
+                m_stride = other.m_stride;
+                return *this;
+            }
             ~buffer_layout() = default;
 
             [[nodiscard]] inline uint32_t stride() const { return m_stride; }
-            [[nodiscard]] inline const std::vector<buffer_elements>& elements() const { return m_elements; }
+            [[nodiscard]] inline std::span<const buffer_elements> elements() const { return m_elements; }
 
-            inline std::vector<buffer_elements>::iterator begin() { return m_elements.begin(); }
-            inline std::vector<buffer_elements>::iterator end() { return m_elements.end(); }
-            inline std::vector<buffer_elements>::const_iterator begin() const { return m_elements.begin(); }
-            inline std::vector<buffer_elements>::const_iterator end() const { return m_elements.end(); }
+            inline const buffer_elements* begin() const { return m_elements.data(); }
+            inline const buffer_elements* end() const { return m_elements.data() + m_elements.size(); }
 
         private:
             inline void _stride(){
                 m_stride = 0;
                 uint32_t offset = 0;
-                for (auto &element : m_elements)
+                for (auto &element : m_storage)
                 {
                     element.offset = offset;
                     offset += element.size;
@@ -157,10 +215,447 @@ namespace gapi{
             }
 
         private:
-            std::vector<buffer_elements> m_elements{};
+            std::vector<buffer_elements> m_storage{};
+            std::span<const buffer_elements> m_elements{};
             uint32_t m_stride{0};
     };
 
+    struct half2        { uint16_t v[2]; };
+    struct half4        { uint16_t v[4]; };
+    struct unorm8x4     { uint8_t v[4]; };
+    struct snorm8x4     { int8_t v[4]; };
+    struct unorm16x2    { uint16_t v[2]; };
+    struct snorm16x2    { int16_t v[2]; };
+    struct snorm16x4    { int16_t v[4]; };
+    struct snorm1010102 { uint32_t v; };
+
+    template<typename Ty> struct attribute_traits;
+
+    template<ATTRIBUTE Type, COMPOENENT Component, bool Normalized = false, bool Integer = false>
+    struct attribute_format{
+        static constexpr ATTRIBUTE type = Type;
+        static constexpr COMPOENENT component = Component;
+        static constexpr bool normalized = Normalized;
+        static constexpr bool integer = Integer;
+    };
+
+    template<> struct attribute_traits<float>        : attribute_format<ATTRIB_FLOAT, X> {};
+    template<> struct attribute_traits<glm::vec2>    : attribute_format<ATTRIB_FLOAT, XY> {};
+    template<> struct attribute_traits<glm::vec3>    : attribute_format<ATTRIB_FLOAT, XYZ> {};
+    template<> struct attribute_traits<glm::vec4>    : attribute_format<ATTRIB_FLOAT, XYZW> {};
+    template<> struct attribute_traits<glm::mat4>    : attribute_format<ATTRIB_FLOAT, XYZW> {};
+    template<> struct attribute_traits<int32_t>      : attribute_format<ATTRIB_INT, X, false, true> {};
+    template<> struct attribute_traits<uint32_t>     : attribute_format<ATTRIB_UINT, X, false, true> {};
+    template<> struct attribute_traits<glm::ivec2>   : attribute_format<ATTRIB_INT, XY, false, true> {};
+    template<> struct attribute_traits<glm::ivec3>   : attribute_format<ATTRIB_INT, XYZ, false, true> {};
+    template<> struct attribute_traits<glm::ivec4>   : attribute_format<ATTRIB_INT, XYZW, false, true> {};
+    template<> struct attribute_traits<glm::uvec2>   : attribute_format<ATTRIB_UINT, XY, false, true> {};
+    template<> struct attribute_traits<glm::uvec3>   : attribute_format<ATTRIB_UINT, XYZ, false, true> {};
+    template<> struct attribute_traits<glm::uvec4>   : attribute_format<ATTRIB_UINT, XYZW, false, true> {};
+    template<> struct attribute_traits<half2>        : attribute_format<ATTRIB_HALF, XY> {};
+    template<> struct attribute_traits<half4>        : attribute_format<ATTRIB_HALF, XYZW> {};
+    template<> struct attribute_traits<unorm8x4>     : attribute_format<ATTRIB_UBYTE, RGBA, true> {};
+    template<> struct attribute_traits<snorm8x4>     : attribute_format<ATTRIB_BYTE, XYZW, true> {};
+    template<> struct attribute_traits<unorm16x2>    : attribute_format<ATTRIB_USHORT, UV, true> {};
+    template<> struct attribute_traits<snorm16x2>    : attribute_format<ATTRIB_SHORT, XY, true> {};
+    template<> struct attribute_traits<snorm16x4>    : attribute_format<ATTRIB_SHORT, XYZW, true> {};
+    template<> struct attribute_traits<snorm1010102> : attribute_format<ATTRIB_INT_2_10_10_10, XYZW, true> {};
+
+    template<size_t N>
+    struct field_name{
+        constexpr field_name(const char (&str)[N]) { std::copy_n(str, N, value); }
+        char value[N]{};
+    };
+
+    template<typename Ty, size_t Offset, field_name Name, uint32_t Divisor = 0>
+    struct vertex_field{
+        using type = Ty;
+        static constexpr size_t offset = Offset;
+
+        [[nodiscard]] static constexpr buffer_elements element(){
+            using traits = attribute_traits<Ty>;
+            buffer_elements e(std::string_view(Name.value), traits::type, traits::component, traits::normalized, traits::integer, Divisor);
+            e.offset = static_cast<uint32_t>(Offset);
+            e.size = static_cast<uint32_t>(sizeof(Ty));
+            return e;
+        }
+    };
+
+    template<typename Vertex, typename... Fields>
+    class static_layout{
+        private:
+            static constexpr bool _contiguous(){
+                constexpr size_t offsets[] = {Fields::offset...};
+                constexpr size_t sizes[] = {sizeof(typename Fields::type)...};
+                constexpr size_t aligns[] = {alignof(typename Fields::type)...};
+                size_t end = 0;
+                for(size_t i = 0; i < sizeof...(Fields); i++){
+                    if(offsets[i] != (end + aligns[i] - 1) / aligns[i] * aligns[i]) return false;
+                    end = offsets[i] + sizes[i];
+                }
+                return (end + alignof(Vertex) - 1) / alignof(Vertex) * alignof(Vertex) == sizeof(Vertex);
+            }
+
+            static_assert(sizeof...(Fields) > 0, "Vertex layout has no fields");
+            static_assert(_contiguous(), "Vertex layout must list every member of the vertex struct in declaration order");
+
+        public:
+            static constexpr uint32_t stride = static_cast<uint32_t>(sizeof(Vertex));
+            static constexpr std::array<buffer_elements, sizeof...(Fields)> elements{Fields::element()...};
+
+            [[nodiscard]] static buffer_layout layout() { return buffer_layout(std::span<const buffer_elements>(elements), stride); }
+            operator buffer_layout() const { return layout(); }
+    };
+
+#define GAPI_FIELD(vertex, member) gapi::vertex_field<decltype(vertex::member), offsetof(vertex, member), #member>
+#define GAPI_INSTANCE_FIELD(vertex, member) gapi::vertex_field<decltype(vertex::member), offsetof(vertex, member), #member, 1>
+
+    enum class BLOCK_LAYOUT : uint32_t{
+        STD140 = 0, STD430 = 1
+    };
+
+    enum BLOCK_DATA : uint32_t{
+        BLOCK_FLOAT, BLOCK_INT, BLOCK_UINT, BLOCK_BOOL,
+        BLOCK_VEC2, BLOCK_VEC3, BLOCK_VEC4,
+        BLOCK_IVEC2, BLOCK_IVEC3, BLOCK_IVEC4,
+        BLOCK_MAT2, BLOCK_MAT3, BLOCK_MAT4
+    };
+
+    struct block_elements{
+        constexpr block_elements() = default;
+        constexpr block_elements(std::string_view name, BLOCK_DATA type, uint32_t count = 1) noexcept
+            : name(name), type(type), count(count) {}
+
+        std::string_view name{};
+        BLOCK_DATA type{BLOCK_FLOAT};
+        uint32_t count{1};
+        uint32_t offset{0};
+        uint32_t stride{0};
+        uint32_t size{0};
+    };
+
+    template<BLOCK_LAYOUT Layout, size_t N>
+    class block_layout{
+        public:
+            constexpr block_layout(const block_elements (&elements)[N]) {
+                uint32_t offset = 0, block_align = Layout == BLOCK_LAYOUT::STD140 ? 16 : 4;
+                for(size_t i = 0; i < N; i++){
+                    auto element = elements[i];
+                    uint32_t align = _align(element);
+                    uint32_t stride = _stride(element);
+                    offset = (offset + align - 1) / align * align;
+                    element.offset = offset;
+                    element.stride = stride;
+                    element.size = element.count > 1 ? stride * element.count : _columns(element.type) > 1 ? _columns(element.type) * _column_stride(element.type) : _bytes(element.type);
+                    offset += element.size;
+                    block_align = align > block_align ? align : block_align;
+                    m_elements[i] = element;
+                }
+                m_size = (offset + block_align - 1) / block_align * block_align;
+            }
+
+            [[nodiscard]] constexpr uint32_t size() const { return m_size; }
+            [[nodiscard]] constexpr const std::array<block_elements, N>& elements() const { return m_elements; }
+
+            [[nodiscard]] constexpr size_t index(std::string_view name) const {
+                for(size_t i = 0; i < N; i++)
+                    if(m_elements[i].name == name) return i;
+                return N;
+            }
+
+            [[nodiscard]] constexpr uint32_t offset(std::string_view name) const {
+                size_t i = index(name);
+                return i < N ? m_elements[i].offset : 0;
+            }
+
+            // GLSL bool is 4 bytes in a block; any other size mismatch is dropped rather than read past the value.
+            template<typename Ty>
+            void write(uint8_t* block, size_t index, const Ty& value, uint32_t element = 0) const {
+                if constexpr (std::is_same_v<Ty, bool>){
+                    write(block, index, static_cast<uint32_t>(value), element);
+                    return;
+                }
+
+                const auto& e = m_elements[index];
+                gapi_asserts(sizeof(Ty) == _bytes(e.type), "Block value size does not match its element type");
+                if(sizeof(Ty) != _bytes(e.type)) return;
+
+                const uint8_t* src = reinterpret_cast<const uint8_t*>(&value);
+                uint8_t* dst = block + e.offset + element * e.stride;
+                uint32_t columns = _columns(e.type), column_bytes = _bytes(e.type) / columns;
+                for(uint32_t c = 0; c < columns; c++)
+                    std::memcpy(dst + c * _column_stride(e.type), src + c * column_bytes, column_bytes);
+            }
+
+        private:
+            static constexpr uint32_t _bytes(BLOCK_DATA type){
+                switch(type){
+                    case BLOCK_VEC2: case BLOCK_IVEC2:  return 8;
+                    case BLOCK_VEC3: case BLOCK_IVEC3:  return 12;
+                    case BLOCK_VEC4: case BLOCK_IVEC4:  return 16;
+                    case BLOCK_MAT2:                    return 16;
+                    case BLOCK_MAT3:                    return 36;
+                    case BLOCK_MAT4:                    return 64;
+                    default:                            return 4;
+                }
+            }
+
+            static constexpr uint32_t _columns(BLOCK_DATA type){
+                switch(type){
+                    case BLOCK_MAT2:    return 2;
+                    case BLOCK_MAT3:    return 3;
+                    case BLOCK_MAT4:    return 4;
+                    default:            return 1;
+                }
+            }
+
+            static constexpr uint32_t _vector_align(uint32_t bytes){
+                return bytes == 4 ? 4 : bytes == 8 ? 8 : 16;
+            }
+
+            static constexpr uint32_t _column_stride(BLOCK_DATA type){
+                uint32_t column = _bytes(type) / _columns(type);
+                if(_columns(type) == 1) return column;
+                uint32_t align = _vector_align(column);
+                if(Layout == BLOCK_LAYOUT::STD140) align = 16;
+                return (column + align - 1) / align * align;
+            }
+
+            static constexpr uint32_t _align(const block_elements& element){
+                uint32_t align = _vector_align(_bytes(element.type) / _columns(element.type));
+                if(Layout == BLOCK_LAYOUT::STD140 && (element.count > 1 || _columns(element.type) > 1)) align = 16;
+                return align;
+            }
+
+            static constexpr uint32_t _stride(const block_elements& element){
+                uint32_t size = _columns(element.type) * _column_stride(element.type);
+                uint32_t align = _align(element);
+                return (size + align - 1) / align * align;
+            }
+
+        private:
+            std::array<block_elements, N> m_elements{};
+            uint32_t m_size{0};
+    };
+
+    template<BLOCK_LAYOUT Layout = BLOCK_LAYOUT::STD140, size_t N>
+    [[nodiscard]] constexpr block_layout<Layout, N> make_block_layout(const block_elements (&elements)[N]){
+        return block_layout<Layout, N>(elements);
+    }
+
+    struct buffer_range{
+        uint32_t buffer{0};
+        uint32_t binding{0};
+        uint32_t offset{0};
+        uint32_t size{0};
+
+        constexpr bool operator==(const buffer_range&) const = default;
+    };
+
+    struct draw_range{
+        uint32_t count{0};
+        uint32_t first{0};
+        int32_t base_vertex{0};
+        uint32_t instances{1};
+        uint32_t base_instance{0};
+    };
+
+    class dirty_ranges{
+        public:
+            struct range{
+                size_t begin{0};
+                size_t end{0};
+            };
+
+            dirty_ranges() = default;
+            explicit dirty_ranges(size_t gap) : m_gap(gap) {}
+            ~dirty_ranges() = default;
+
+            void add(size_t begin, size_t end){
+                if(begin >= end) return;
+                auto first = std::lower_bound(m_ranges.begin(), m_ranges.end(), begin, [this](const range& r, size_t value){ return r.end + m_gap < value; });
+                auto last = first;
+                while(last != m_ranges.end() && last->begin <= end + m_gap){
+                    begin = std::min(begin, last->begin);
+                    end = std::max(end, last->end);
+                    last++;
+                }
+
+                if(first == last){
+                    m_ranges.insert(first, {begin, end});
+                    return;
+                }
+
+                *first = {begin, end};
+                m_ranges.erase(first + 1, last);
+            }
+
+            [[nodiscard]] inline size_t bytes() const {
+                size_t total = 0;
+                for(const auto& r : m_ranges) total += r.end - r.begin;
+                return total;
+            }
+
+            [[nodiscard]] inline const std::vector<range>& ranges() const { return m_ranges; }
+            [[nodiscard]] inline bool empty() const { return m_ranges.empty(); }
+            inline void clear() { m_ranges.clear(); }
+
+        private:
+            std::vector<range> m_ranges{};
+            size_t m_gap{0};
+    };
+
+    class range_allocator{
+        public:
+            static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+            range_allocator() = default;
+            explicit range_allocator(uint32_t capacity) : m_free{{0, capacity}}, m_capacity(capacity) {}
+            ~range_allocator() = default;
+
+            [[nodiscard]] uint32_t allocate(uint32_t size){
+                if(size == 0) return INVALID;
+                for(auto it = m_free.begin(); it != m_free.end(); it++){
+                    if(it->size < size) continue;
+                    uint32_t offset = it->offset;
+                    it->offset += size;
+                    it->size -= size;
+                    if(it->size == 0) m_free.erase(it);
+                    return offset;
+                }
+                return INVALID;
+            }
+
+            void release(uint32_t offset, uint32_t size){
+                if(offset == INVALID || size == 0) return;
+                auto it = std::lower_bound(m_free.begin(), m_free.end(), offset, [](const block& b, uint32_t value){ return b.offset < value; });
+                it = m_free.insert(it, {offset, size});
+
+                auto next = it + 1;
+                if(next != m_free.end() && it->offset + it->size == next->offset){
+                    it->size += next->size;
+                    m_free.erase(next);
+                }
+
+                if(it != m_free.begin()){
+                    auto prev = it - 1;
+                    if(prev->offset + prev->size == it->offset){
+                        prev->size += it->size;
+                        m_free.erase(it);
+                    }
+                }
+            }
+
+            [[nodiscard]] inline uint32_t capacity() const { return m_capacity; }
+            [[nodiscard]] inline uint32_t available() const {
+                uint32_t total = 0;
+                for(const auto& b : m_free) total += b.size;
+                return total;
+            }
+
+        private:
+            struct block{
+                uint32_t offset{0};
+                uint32_t size{0};
+            };
+
+            std::vector<block> m_free{};
+            uint32_t m_capacity{0};
+    };
+
+    // Bottom-left skyline rectangle packer.
+    class skyline_packer{
+        public:
+            struct rect{
+                int32_t x{-1};
+                int32_t y{-1};
+                int32_t width{0};
+                int32_t height{0};
+
+                [[nodiscard]] inline bool valid() const { return x >= 0; }
+            };
+
+            skyline_packer() = default;
+            skyline_packer(int32_t width, int32_t height) : m_nodes{{0, 0, width}}, m_width(width), m_height(height) {}
+            ~skyline_packer() = default;
+
+            [[nodiscard]] rect pack(int32_t width, int32_t height){
+                size_t best = m_nodes.size();
+                int32_t best_y = m_height, best_top = m_height + 1, best_width = m_width + 1;
+
+                for(size_t i = 0; i < m_nodes.size(); i++){
+                    int32_t y = fit(i, width, height);
+                    if(y < 0) continue;
+                    if(y + height < best_top || (y + height == best_top && m_nodes[i].width < best_width)){
+                        best = i;
+                        best_y = y;
+                        best_top = y + height;
+                        best_width = m_nodes[i].width;
+                    }
+                }
+
+                if(best == m_nodes.size()) return {};
+
+                rect r{m_nodes[best].x, best_y, width, height};
+                m_nodes.insert(m_nodes.begin() + best, {r.x, r.y + height, width});
+
+                for(size_t i = best + 1; i < m_nodes.size();){
+                    const int32_t right = m_nodes[i - 1].x + m_nodes[i - 1].width;
+                    if(m_nodes[i].x >= right) break;
+
+                    const int32_t shrink = right - m_nodes[i].x;
+                    m_nodes[i].x += shrink;
+                    m_nodes[i].width -= shrink;
+                    if(m_nodes[i].width > 0) break;
+                    m_nodes.erase(m_nodes.begin() + i);
+                }
+
+                for(size_t i = 0; i + 1 < m_nodes.size();){
+                    if(m_nodes[i].y == m_nodes[i + 1].y){
+                        m_nodes[i].width += m_nodes[i + 1].width;
+                        m_nodes.erase(m_nodes.begin() + i + 1);
+                    }
+                    else i++;
+                }
+
+                m_used += int64_t(width) * height;
+                return r;
+            }
+
+            void clear(){
+                m_nodes = {{0, 0, m_width}};
+                m_used = 0;
+            }
+
+            [[nodiscard]] inline int32_t width() const { return m_width; }
+            [[nodiscard]] inline int32_t height() const { return m_height; }
+            [[nodiscard]] inline float occupancy() const { return m_width && m_height ? float(m_used) / (float(m_width) * m_height) : 0.0f; }
+
+        private:
+            struct node{
+                int32_t x{0};
+                int32_t y{0};
+                int32_t width{0};
+            };
+
+            int32_t fit(size_t index, int32_t width, int32_t height) const {
+                if(m_nodes[index].x + width > m_width) return -1;
+
+                int32_t y = 0;
+                for(int32_t remaining = width; remaining > 0; index++){
+                    y = std::max(y, m_nodes[index].y);
+                    if(y + height > m_height) return -1;
+                    remaining -= m_nodes[index].width;
+                }
+                return y;
+            }
+
+            std::vector<node> m_nodes{};
+            int32_t m_width{0};
+            int32_t m_height{0};
+            int64_t m_used{0};
+    };
+
     class vertex_buffer{
         public:
             constexpr vertex_buffer() = default;
@@ -169,10 +664,52 @@ namespace gapi{
             virtual void bind() const = 0;
             [[maybe_unused]] virtual void unbind() const = 0;
 
+            virtual void update(size_t offset, std::span<const std::byte> data) = 0;
+            virtual void flush() = 0;
+
+            template<typename Ty>
+            void update(size_t offset, std::span<const Ty> data) { update(offset, std::as_bytes(data)); }
+
             virtual void configure_layout(const buffer_layout& layout) = 0;
             virtual const buffer_layout& layout() const = 0;
     };
 
+    enum class INDEX : uint32_t{
+        U8 = 1, U16 = 2, U32 = 4
+    };
+
+    struct index_data{
+        INDEX type{INDEX::U32};
+        uint32_t count{0};
+        std::vector<uint8_t> bytes{};
+    };
+
+    template<typename Ty>
+    inline void convert_indices(const uint32_t* src, uint32_t count, Ty* dst){
+        for(uint32_t i = 0; i < count; i++) dst[i] = static_cast<Ty>(src[i]);
+    }
+
+    inline void convert_indices(const uint32_t* src, uint32_t count, INDEX type, void* dst){
+        switch(type){
+            case INDEX::U8:     convert_indices(src, count, static_cast<uint8_t*>(dst));    break;
+            case INDEX::U16:    convert_indices(src, count, static_cast<uint16_t*>(dst));   break;
+            case INDEX::U32:    std::memcpy(dst, src, count * sizeof(uint32_t));            break;
+        }
+    }
+
+    [[nodiscard]] inline INDEX index_type_for(uint32_t vertex_count, bool allow_u8 = false){
+        if(allow_u8 && vertex_count <= 0x100) return INDEX::U8;
+        if(vertex_count <= 0x10000) return INDEX::U16;
+        return INDEX::U32;
+    }
+
+    [[nodiscard]] inline index_data narrow_indices(const uint32_t* indices, uint32_t count, uint32_t vertex_count, bool allow_u8 = false){
+        index_data data{index_type_for(vertex_count, allow_u8), count, {}};
+        data.bytes.resize(static_cast<size_t>(count) * static_cast<uint32_t>(data.type));
+        convert_indices(indices, count, data.type, data.bytes.data());
+        return data;
+    }
+
     class index_buffer{
         public:
             index_buffer() = default;
@@ -181,6 +718,13 @@ namespace gapi{
             virtual void bind() const = 0;
             [[maybe_unused]] virtual void unbind() const = 0;
             virtual uint32_t count() const = 0;
+            virtual INDEX type() const = 0;
+
+            virtual void update(size_t offset, std::span<const std::byte> data) = 0;
+            virtual void flush() = 0;
+
+            template<typename Ty>
+            void update(size_t offset, std::span<const Ty> data) { update(offset, std::as_bytes(data)); }
     };
 
     class vertex_array{
@@ -192,10 +736,12 @@ namespace gapi{
             virtual void bind() const = 0;
             [[maybe_unused]] virtual void unbind() const = 0;
 
+            virtual uint32_t id() const = 0;
             virtual void emplace_vertex(const std::shared_ptr<vertex_buffer>& vertex_buffer)  = 0;
             virtual void emplace_index(const std::shared_ptr<index_buffer>& index_buffer) = 0;
             inline virtual const std::vector<std::shared_ptr<vertex_buffer>>& vertexs() const = 0;
             inline virtual const std::shared_ptr<index_buffer>& index() const = 0;
+            virtual INDEX index_type() const = 0;
     };
 
     class shader{
@@ -206,7 +752,12 @@ namespace gapi{
             virtual void bind() const = 0;
             [[maybe_unused]] virtual void unbind() const = 0;
 
+            virtual uint32_t id() const = 0;
             virtual const std::string& name() const = 0;
+            // Polls a deferred build and finishes it once the driver is done. Only non-blocking with
+            // KHR/ARB_parallel_shader_compile; without it the first call finishes the build and waits for the link.
+            virtual bool ready() = 0;
+            virtual void wait() = 0;
             virtual bool uniform(const std::string& n, uint32_t v) const = 0;
             virtual bool uniform(const std::string& n, float v) const = 0;
             virtual bool uniform(const std::string& n, float x, float y) const = 0;
@@ -218,6 +769,18 @@ namespace gapi{
             virtual bool uniform(const std::string& n, const glm::mat2& v) const = 0;
             virtual bool uniform(const std::string& n, const glm::mat3& v) const = 0;
             virtual bool uniform(const std::string& n, const glm::mat4& v) const = 0;
+
+            virtual bool block(std::string_view n, uint32_t binding) const = 0;
+            virtual uniform_handle handle(std::string_view n) const = 0;
+            virtual uniform_handle handle(uint32_t name_hash) const = 0;
+            virtual bool uniform(uniform_handle h, uint32_t v) const = 0;
+            virtual bool uniform(uniform_handle h, float v) const = 0;
+            virtual bool uniform(uniform_handle h, const glm::vec2& v) const = 0;
+            virtual bool uniform(uniform_handle h, const glm::vec3& v) const = 0;
+            virtual bool uniform(uniform_handle h, const glm::vec4& v) const = 0;
+            virtual bool uniform(uniform_handle h, const glm::mat2& v) const = 0;
+            virtual bool uniform(uniform_handle h, const glm::mat3& v) const = 0;
+            virtual bool uniform(uniform_handle h, const glm::mat4& v) const = 0;
     };
 
     class texture{
@@ -242,9 +805,16 @@ namespace gapi{
             virtual ~base_api() = default;
 
             virtual void init() = 0;
-            virtual void draw(const std::shared_ptr<vertex_array>& va) = 0;
+            virtual void draw(const vertex_array& va) = 0;
+            virtual void draw(const vertex_array& va, const draw_range& range) = 0;
+            virtual void draw_multi(const vertex_array& va, std::span<const draw_range> ranges) = 0;
+            inline void draw(const std::shared_ptr<vertex_array>& va) { draw(*va); }
+            inline void draw_instanced(const vertex_array& va, uint32_t instances, uint32_t base_instance = 0) {
+                draw(va, {0, 0, 0, instances, base_instance});
+            }
             virtual void clear()  = 0;
             virtual void clear_color(float r, float g, float b, float a) = 0;   
+            virtual void bind_range(const buffer_range& range) = 0;
             virtual GAPI xapi() const  = 0;   
     };
 
@@ -261,8 +831,8 @@ namespace gapi{
             }
 
             template<typename Ty, typename... TArgs>
-            [[nodiscard]] std::shared_ptr<shader> load(TArgs... args) const {
-                auto shader = make_shader<Ty>(std::forward<TArgs>(args)...);
+            std::shared_ptr<shader> load(TArgs&&... args){
+                auto shader = std::make_shared<Ty>(std::forward<TArgs>(args)...);
                 emplace(shader);
                 return shader;
             }
@@ -273,6 +843,24 @@ namespace gapi{
                 return it->second;
             }
 
+            [[nodiscard]] bool ready(const std::string& name){
+                return get(name)->ready();
+            }
+
+            // Polls every program still building and returns how many remain. Without parallel shader compile
+            // each poll finishes its build, so this blocks until every program has linked, one after another.
+            [[nodiscard]] size_t pending(){
+                size_t count = 0;
+                for(auto& [name, shader] : m_shaders) count += !shader->ready();
+                return count;
+            }
+
+            [[nodiscard]] inline bool ready() { return pending() == 0; }
+
+            void wait(){
+                for(auto& [name, shader] : m_shaders) shader->wait();
+            }
+
         private:
             std::unordered_map<std::string, std::shared_ptr<shader>> m_shaders{};
     };
@@ -1,4 +1,8 @@
 #include "gapi_impl_opengl.hpp"
+#include "gapi_vertex_pack.hpp"
+#include <cctype>
+#include <iomanip>
+#include <numeric>
 
 #ifdef _DEBUG
 #include <iostream>
@@ -75,414 +79,2459 @@ namespace gapi::opengl{
         m_renderer      = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
         m_glsl_version  = reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION));
 
-        char GL_MAJOR = m_version[0];
-        char GL_MINOR = m_version[2];
-        char GL_PATCH = m_version[4];
+        // "4.6.0 NVIDIA 550.54" and "4.5 (Core Profile) Mesa 23.2.1" both lead with major.minor.
+        std::sscanf(m_version.c_str(), "%d.%d", &m_major, &m_minor);
 
         std::stringstream ss;
-        ss << "#version " << GL_MAJOR << GL_MINOR << GL_PATCH << " core";
+        ss << "#version " << m_major << m_minor << "0 core";
         m_glsl_version = ss.str();
-    }
-
-    bool context::init() {
-        gapi_asserts(m_window != nullptr, "Window is nullptr");
-        glfwMakeContextCurrent(m_window);
-        glfwSwapInterval(1);
 
-        glewExperimental = GL_TRUE;
-        if(GLenum status = glewInit() != GLEW_OK){
-            gapi_asserts(status, "Failed to initialize GLEW");
-            return false;
+        GLint count = 0;
+        gl(glGetIntegerv(GL_NUM_EXTENSIONS, &count));
+        m_extensions.reserve(count);
+        for(GLint i = 0; i < count; i++){
+            const GLubyte* extension = gl(glGetStringi(GL_EXTENSIONS, i));
+            if(extension) m_extensions.emplace_back(reinterpret_cast<const char*>(extension));
         }
-
-        m_info = std::make_shared<gapi::opengl::info>();
-        return true;
+        std::sort(m_extensions.begin(), m_extensions.end());
     }
 
-    void context::swap(){
-        gapi_asserts(m_window != nullptr, "Window is nullptr");
-        glfwSwapBuffers(m_window);
+    bool info::supports(std::string_view extension) const {
+        auto it = std::lower_bound(m_extensions.begin(), m_extensions.end(), extension, [](const std::string& a, std::string_view b){ return a < b; });
+        return it != m_extensions.end() && *it == extension;
     }
 
-    void context::interval(uint32_t interval){
-        gapi_asserts(m_window != nullptr, "Window is nullptr");
-        glfwSwapInterval(interval);
+    bool info::supports_format(uint32_t f) const {
+        const int32_t version = m_major * 10 + m_minor;
+        if(f >= GL_COMPRESSED_RGB_S3TC_DXT1_EXT && f <= GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+            return supports("GL_EXT_texture_compression_s3tc");
+        if(f >= GL_COMPRESSED_SRGB_S3TC_DXT1_EXT && f <= GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT)
+            return supports("GL_EXT_texture_compression_s3tc") && (supports("GL_EXT_texture_sRGB") || supports("GL_EXT_texture_compression_s3tc_srgb"));
+        if(f >= GL_COMPRESSED_RED_RGTC1 && f <= GL_COMPRESSED_SIGNED_RG_RGTC2)
+            return version >= 30 || supports("GL_ARB_texture_compression_rgtc");
+        if(f >= GL_COMPRESSED_RGBA_BPTC_UNORM && f <= GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT)
+            return version >= 42 || supports("GL_ARB_texture_compression_bptc");
+        if(f >= GL_COMPRESSED_R11_EAC && f <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC)
+            return version >= 43 || supports("GL_ARB_ES3_compatibility");
+        if((f >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR && f <= GL_COMPRESSED_RGBA_ASTC_4x4_KHR + 13) ||
+           (f >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR && f <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + 13))
+            return supports("GL_KHR_texture_compression_astc_ldr");
+        return false;
     }
 
-    vertex_buffer::vertex_buffer(float * v, uint32_t s, DRAW t){
-        gl(glGenBuffers(1, &m_id));
-        gl(glBindBuffer(GL_ARRAY_BUFFER, m_id));
-        gl(glBufferData(GL_ARRAY_BUFFER, s, v, static_cast<GLenum>(t)));
+    static thread_local state_cache* s_current_state{nullptr};
+
+    static size_t texture_target_index(TEXTURE_TYPE target){
+        switch(target){
+            case TEXTURE_2D:        return 0;
+            case TEXTURE_2D_ARRAY:  return 1;
+            case TEXTURE_3D:        return 2;
+            case TEXTURE_CUBE_MAP:  return 3;
+            default:                return 0;
+        }
     }
 
-    vertex_buffer::~vertex_buffer(){
-        gl(glDeleteBuffers(1, &m_id));
+    state_cache& state_cache::current(){
+        static thread_local state_cache fallback{};
+        return s_current_state ? *s_current_state : fallback;
     }
 
-    void vertex_buffer::bind() const{
-        gl(glBindBuffer(GL_ARRAY_BUFFER, m_id));
+    void state_cache::make_current(state_cache* cache){
+        s_current_state = cache;
     }
 
-    void vertex_buffer::unbind() const{
-        gl(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    bool state_cache::redundant(uint32_t& shadow, uint32_t id){
+        if(shadow == id){
+            m_counters.skipped++;
+            return true;
+        }
+
+        shadow = id;
+        m_counters.issued++;
+        return false;
     }
 
-    index_buffer::index_buffer(uint32_t* i, size_t c, DRAW t){
-        gl(glGenBuffers(1, &m_id));
-        gl(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id));
-        gl(glBufferData(GL_ELEMENT_ARRAY_BUFFER, c, i, static_cast<GLenum>(t)));
+    void state_cache::active_unit(uint32_t unit){
+        if(m_active_unit == unit) return;
+        gl(glActiveTexture(GL_TEXTURE0 + unit));
+        m_active_unit = unit;
     }
 
-    index_buffer::~index_buffer(){
-        gl(glDeleteBuffers(1, &m_id));
+    void state_cache::bind_program(uint32_t id){
+        if(redundant(m_program, id)) return;
+        GAPI_STAT(program_binds, 1);
+        gl(glUseProgram(id));
     }
 
-    void index_buffer::bind() const {
-        gl(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id));
+    void state_cache::bind_vertex_array(uint32_t id){
+        if(redundant(m_vertex_array, id)) return;
+        GAPI_STAT(vertex_array_binds, 1);
+        gl(glBindVertexArray(id));
+        m_element_buffer = UNKNOWN;
     }
 
-    void index_buffer::unbind() const {
-        gl(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    void state_cache::bind_buffer(GLenum target, uint32_t id){
+        uint32_t* shadow = nullptr;
+        if(target == GL_ARRAY_BUFFER) shadow = &m_array_buffer;
+        else if(target == GL_ELEMENT_ARRAY_BUFFER) shadow = &m_element_buffer;
+
+        if(shadow == nullptr){
+            m_counters.issued++;
+            gl(glBindBuffer(target, id));
+            return;
+        }
+
+        if(redundant(*shadow, id)) return;
+        gl(glBindBuffer(target, id));
     }
 
-    vertex_array::vertex_array(){
-        gl(glGenVertexArrays(1, &m_id));
+    void state_cache::bind_texture(uint32_t unit, TEXTURE_TYPE target, uint32_t id){
+        if(unit >= MAX_TEXTURE_UNITS){
+            m_counters.issued++;
+            GAPI_STAT(texture_binds, 1);
+            active_unit(unit);
+            gl(glBindTexture(target, id));
+            return;
+        }
+
+        if(redundant(m_textures[unit][texture_target_index(target)], id)) return;
+        GAPI_STAT(texture_binds, 1);
+        active_unit(unit);
+        gl(glBindTexture(target, id));
     }
 
-    vertex_array::~vertex_array(){
-        gl(glDeleteVertexArrays(1, &m_id));
+    void state_cache::release_program(uint32_t id){
+        if(m_program == id) m_program = UNKNOWN;
     }
 
-    void vertex_array::bind() const {
-        gl(glBindVertexArray(m_id));
+    void state_cache::release_vertex_array(uint32_t id){
+        if(m_vertex_array != id) return;
+        m_vertex_array = 0;
+        m_element_buffer = UNKNOWN;
     }
 
-    void vertex_array::unbind() const {
-        gl(glBindVertexArray(0));
+    void state_cache::release_buffer(uint32_t id){
+        if(m_array_buffer == id) m_array_buffer = 0;
+        if(m_element_buffer == id) m_element_buffer = 0;
     }
 
-    void vertex_array::emplace_vertex(const std::shared_ptr<gapi::vertex_buffer>& vb){
-        vb->bind();
-        const auto& layout = vb->layout();
-        const auto& elements = layout.elements();
-        size_t index = 0;
-        for(const auto& element : elements)
-        {
-            gl(glEnableVertexAttribArray(index));
-            gl(glVertexAttribPointer(index, element.component, FLOAT, 
-                element.normalized, layout.stride(), (const void*)(element.offset)));
-            index++;
+    void state_cache::release_texture(uint32_t id){
+        for(auto& unit : m_textures){
+            for(auto& bound : unit){
+                if(bound == id) bound = 0;
+            }
         }
-        m_vertex_buffers.emplace_back(vb);
     }
 
-    void vertex_array::emplace_index(const std::shared_ptr<gapi::index_buffer>& ib){
-        ib->bind();
-        m_index_buffer = ib;
+    void state_cache::invalidate(){
+        m_program = UNKNOWN;
+        m_vertex_array = UNKNOWN;
+        m_array_buffer = UNKNOWN;
+        m_element_buffer = UNKNOWN;
+        m_active_unit = UNKNOWN;
+        for(auto& unit : m_textures) unit.fill(UNKNOWN);
     }
 
-    uint32_t shader::validator(const std::string& n) const {
-        uint32_t uniform_location = gl(glGetUniformLocation(m_id, n.c_str()));
-        if(uniform_location == -1) {
-            gapi_debug_msg("Uniform not found: ", n);
-            return -1;
-        }
+    static thread_local profiler* s_current_profiler{nullptr};
 
-        return uniform_location;
+    profiler::profiler(): m_epoch(std::chrono::steady_clock::now()){
+        m_gpu = GLEW_ARB_timer_query;
+        for(size_t i = 0; i < m_slots.size(); i++) m_slots[i].frame = i;
     }
 
-    void shader::compile(std::unordered_map<SHADER_TYPE, std::string> sources){
-        uint32_t shader_program = gl(glCreateProgram());
-        if(shader_program == GL_FALSE) return;
-
-        std::vector<uint32_t> shaders;
-        shaders.reserve(sources.size());
+    profiler::~profiler(){
+        if(s_current_profiler == this) make_current(nullptr);
+        for(auto& s : m_slots){
+            if(!s.queries.empty()){
+                gl(glDeleteQueries(static_cast<GLsizei>(s.queries.size()), s.queries.data()));
+            }
+        }
+    }
 
-        for(auto& source : sources){
-            SHADER_TYPE type = source.first;
-            const std::string& src = source.second;
+    profiler* profiler::current(){
+        return s_current_profiler;
+    }
 
-            uint32_t shader_id = gl(glCreateShader(static_cast<GLenum>(type)));
-            const char* src_cstr = src.c_str();
+    void profiler::make_current(profiler* instance){
+        s_current_profiler = instance;
+    }
 
-            gl(glShaderSource(shader_id, 1, &src_cstr, nullptr));
-            gl(glCompileShader(shader_id));
+    double profiler::now() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_epoch).count();
+    }
 
-            int32_t result{0};
-            gl(glGetShaderiv(shader_id, GL_COMPILE_STATUS, &result));
+    uint32_t profiler::begin(const char* name){
+        auto& s = m_slots[m_frame % m_slots.size()];
+        const uint32_t index = static_cast<uint32_t>(s.zones.size());
+        s.zones.push_back({name, m_depth++, m_frame, now()});
 
-            if(result == GL_FALSE){
-                int message_length = 0;
-                gl(glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &message_length));
-                std::vector<char> compile_error_message(message_length);
-                gl(glGetShaderInfoLog(shader_id, message_length, &message_length, &compile_error_message[0]));
-                gapi_debug_msg("Shader compilation error: ", compile_error_message.data());
+        if(m_gpu){
+            if(s.queries.size() < 2 * (index + 1)){
+                const size_t grown = s.queries.size();
+                s.queries.resize(grown + 128);
+                gl(glGenQueries(128, s.queries.data() + grown));
             }
-
-            gl(glAttachShader(shader_program, shader_id));
-            shaders.push_back(shader_id);
+            gl(glQueryCounter(s.queries[2 * index], GL_TIMESTAMP));
         }
+        return index;
+    }
 
-        int result{0};
-        gl(glLinkProgram(shader_program));
-        gl(glGetProgramiv(shader_program, GL_LINK_STATUS, &result));
+    void profiler::end(uint64_t frame, uint32_t zone){
+        auto& s = m_slots[frame % m_slots.size()];
+        m_depth--;
+        if(s.frame != frame || zone >= s.zones.size()) return;
 
-        if(result == GL_FALSE){
-            int message_length = 0;
-            gl(glGetProgramiv(shader_program, GL_INFO_LOG_LENGTH, &message_length));
-            std::vector<char> link_error_message(message_length);
-            gl(glGetProgramInfoLog(shader_program, message_length, &message_length, &link_error_message[0]));
-            gapi_debug_msg("Shader linking error: ", link_error_message.data());
+        s.zones[zone].cpu_end = now();
+        if(m_gpu){
+            gl(glQueryCounter(s.queries[2 * zone + 1], GL_TIMESTAMP));
         }
+    }
 
-        gl(glValidateProgram(shader_program));
-        gl(glGetProgramiv(shader_program, GL_VALIDATE_STATUS, &result));
+    void profiler::resolve(slot& s){
+        m_resolved.clear();
 
-        if(result == GL_FALSE){
-            int message_length = 0;
-            gl(glGetProgramiv(shader_program, GL_INFO_LOG_LENGTH, &message_length));
-            std::vector<char> validate_error_message(message_length);
-            gl(glGetProgramInfoLog(shader_program, message_length, &message_length, &validate_error_message[0]));
-            gapi_debug_msg("Shader validation error: ", validate_error_message.data());
+        bool available = m_gpu;
+        for(size_t i = 0; available && i < 2 * s.zones.size(); i++){
+            GLint ready = GL_FALSE;
+            gl(glGetQueryObjectiv(s.queries[i], GL_QUERY_RESULT_AVAILABLE, &ready));
+            available = ready != GL_FALSE;
         }
 
-        for(auto& shader : shaders){
-            gl(glDetachShader(shader_program, shader));
-            gl(glDeleteShader(shader));
+        for(size_t i = 0; i < s.zones.size(); i++){
+            profile_event e = s.zones[i];
+            if(e.cpu_end == 0.0) continue;
+
+            if(available){
+                GLuint64 begin = 0, end = 0;
+                gl(glGetQueryObjectui64v(s.queries[2 * i], GL_QUERY_RESULT, &begin));
+                gl(glGetQueryObjectui64v(s.queries[2 * i + 1], GL_QUERY_RESULT, &end));
+                e.gpu_begin = begin / 1000.0 + s.offset;
+                e.gpu_end = end / 1000.0 + s.offset;
+                e.gpu = true;
+            }
+            m_resolved.push_back(e);
         }
 
-        m_id = shader_program;
+        if(m_capture) m_trace.insert(m_trace.end(), m_resolved.begin(), m_resolved.end());
     }
 
-    std::string shader::read_file(const std::filesystem::path& file_path) const{
-        std::string result;
-        std::ifstream infile(file_path, std::ios::in | std::ios::binary);
-        if(infile){
-            infile.seekg(0, std::ios::end);
-            result.resize(infile.tellg());
-            infile.seekg(0, std::ios::beg);
-            infile.read(&result[0], result.size());
-            infile.close();
-            return result;
+    void profiler::end_frame(){
+        gapi_asserts(m_depth == 0, "Profiler frame ended inside a zone");
+        auto& finished = m_slots[m_frame % m_slots.size()];
+        if(m_gpu){
+            GLint64 timestamp = 0;
+            gl(glGetInteger64v(GL_TIMESTAMP, &timestamp));
+            finished.offset = now() - timestamp / 1000.0;
         }
 
-        gapi_debug_msg("Failed to read file: ", file_path.string());
-        return "";
+        m_frame++;
+        auto& next = m_slots[m_frame % m_slots.size()];
+        if(!next.zones.empty()) resolve(next);
+        next.zones.clear();
+        next.frame = m_frame;
     }
 
-    static SHADER_TYPE shader_type_from_string(const std::string &type){
-        if(type == "vertex")                          return SHADER_TYPE::SHADER_VERTEX;
-        if(type == "fragment" || type == "pixel")     return SHADER_TYPE::SHADER_FRAGMENT;
-        if(type == "geometry")                        return SHADER_TYPE::SHADER_GEOMETRY;
-        gapi_asserts(true, "Invalid shader type specified");
-        return SHADER_TYPE::SHADER_NONE;
+    static void write_json_string(std::ostream& out, const char* str){
+        out << '"';
+        for(const char* c = str ? str : ""; *c; c++){
+            if(*c == '"' || *c == '\\') out << '\\' << *c;
+            else if(static_cast<unsigned char>(*c) < 0x20) out << ' ';
+            else out << *c;
+        }
+        out << '"';
     }
 
-    std::unordered_map<SHADER_TYPE, std::string> shader::pre_process(const std::string& src) const {
-        std::unordered_map<SHADER_TYPE,std::string> shader_sources;
-        const char *type_token = "#type";
-        size_t type_token_length = strlen(type_token);
-        size_t pos = src.find(type_token, 0);
+    bool profiler::write_trace(const std::filesystem::path& path) const {
+        std::ofstream out(path, std::ios::out | std::ios::trunc);
+        if(!out){
+            gapi_debug_msg("Failed to write trace: ", path.string());
+            return false;
+        }
 
-        while(pos != std::string::npos){
-            size_t eol = src.find_first_of("\r\n", pos);
-            gapi_asserts(eol == std::string::npos, "Syntax error, Did you forget to add shader type line #type declaration");
-            size_t begin = pos + type_token_length + 1;
-            std::string type = src.substr(begin, eol - begin);
-            gapi_asserts(type != "vertex" && type != "fragment" && type != "pixel" && type != "geometry", "Invalid shader type specified");
-            size_t next_line_pos = src.find_first_not_of("\r\n", eol);
-            pos = src.find(type_token, next_line_pos);
-            shader_sources[shader_type_from_string(type)] = src.substr(next_line_pos, pos - (next_line_pos == std::string::npos ? src.size() - 1 : next_line_pos));
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+        out << std::fixed << std::setprecision(3);
+
+        auto write = [&](const profile_event& e, uint32_t track, double begin, double end){
+            out << ",\n{\"name\":";
+            write_json_string(out, e.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << track << ",\"ts\":" << begin << ",\"dur\":" << std::max(0.0, end - begin);
+            out << ",\"args\":{\"frame\":" << e.frame << ",\"depth\":" << e.depth << "}}";
+        };
+
+        for(const auto& e : m_trace){
+            write(e, 1, e.cpu_begin, e.cpu_end);
+            if(e.gpu) write(e, 2, e.gpu_begin, e.gpu_end);
         }
 
-        return shader_sources;
+        out << "\n]}\n";
+        return static_cast<bool>(out);
     }
 
-    shader::shader(const std::string& sname, const std::filesystem::path& path){
-        if(!std::filesystem::exists(path)){
-            gapi_debug_msg("Shader parse error: ", "Shader file does not exist");
-            return;
-        }
+    static thread_local frame_stats* s_current_stats{nullptr};
 
-        std::string source = read_file(path);
-        auto shader_sources = pre_process(source);
-        compile(shader_sources);
-        m_name = sname;
+    frame_stats::~frame_stats(){
+        if(s_current_stats == this) make_current(nullptr);
     }
 
-    shader::shader(const std::string& sname, const std::filesystem::path& vertex, const std::filesystem::path& fragment){
-        if(!std::filesystem::exists(vertex) || !std::filesystem::exists(fragment)){
-            gapi_debug_msg("Shader parse error: ", "Shader file does not exist");
-            return;
-        }
+    frame_counters& frame_stats::current(){
+        static thread_local frame_counters scratch{};
+        return s_current_stats ? s_current_stats->m_frame : scratch;
+    }
 
-        std::string vertex_source = read_file(vertex);
-        std::string fragment_source = read_file(fragment);
-        std::unordered_map<SHADER_TYPE, std::string> shader_sources = {
-            {SHADER_VERTEX, vertex_source},
-            {SHADER_FRAGMENT, fragment_source}
-        };
-        compile(shader_sources);
-        m_name = sname;
+    void frame_stats::make_current(frame_stats* stats){
+        s_current_stats = stats;
     }
 
-    shader::~shader(){
-        gl(glDeleteProgram(m_id));
+    void frame_stats::end_frame(){
+        m_history[m_head] = m_frame;
+        m_head = (m_head + 1) % WINDOW;
+        m_count = std::min(m_count + 1, WINDOW);
+        m_frame = {};
     }
 
-    void shader::bind() const {
-        gl(glUseProgram(m_id));
+    void frame_stats::reset(){
+        m_frame = {};
+        m_head = 0;
+        m_count = 0;
     }
 
-    void shader::unbind() const {
-        gl(glUseProgram(0));
+    frame_stats::summary frame_stats::rolling(uint64_t frame_counters::* counter) const {
+        if(m_count == 0) return {};
+
+        std::array<uint64_t, WINDOW> values{};
+        for(uint32_t i = 0; i < m_count; i++) values[i] = m_history[(m_head + WINDOW - m_count + i) % WINDOW].*counter;
+
+        summary s{};
+        auto [lo, hi] = std::minmax_element(values.begin(), values.begin() + m_count);
+        s.min = static_cast<double>(*lo);
+        s.max = static_cast<double>(*hi);
+        s.avg = static_cast<double>(std::accumulate(values.begin(), values.begin() + m_count, uint64_t{0})) / m_count;
+
+        const uint32_t rank = (m_count * 99 + 99) / 100 - 1;
+        std::nth_element(values.begin(), values.begin() + rank, values.begin() + m_count);
+        s.p99 = static_cast<double>(values[rank]);
+        return s;
     }
 
-    bool shader::uniform(const std::string& n, uint32_t v) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniform1i(uniform_location, v));
-        return true;
+    context::~context(){
+        if(s_current_state == &m_state) state_cache::make_current(nullptr);
     }
 
-    bool shader::uniform(const std::string& n, float v) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniform1f(uniform_location, v));
+    bool context::init() {
+        gapi_asserts(m_window != nullptr, "Window is nullptr");
+        glfwMakeContextCurrent(m_window);
+        state_cache::make_current(&m_state);
+        glfwSwapInterval(1);
+
+        glewExperimental = GL_TRUE;
+        if(GLenum status = glewInit() != GLEW_OK){
+            gapi_asserts(status, "Failed to initialize GLEW");
+            return false;
+        }
+
+        m_info = std::make_shared<gapi::opengl::info>();
+        if(GLEW_KHR_parallel_shader_compile){
+            gl(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+        }
+        else if(GLEW_ARB_parallel_shader_compile){
+            gl(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+        }
         return true;
     }
 
-    bool shader::uniform(const std::string& n, float x, float y) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniform2f(uniform_location, x, y));
-        return true;
+    void context::swap(){
+        gapi_asserts(m_window != nullptr, "Window is nullptr");
+        {
+            GAPI_PROFILE_ZONE("context::swap");
+            glfwSwapBuffers(m_window);
+        }
+#ifdef GAPI_PROFILE
+        if(profiler* instance = profiler::current()) instance->end_frame();
+#endif
     }
 
-    bool shader::uniform(const std::string& n, float x, float y, float z) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniform3f(uniform_location, x, y, z));
-        return true;
+    void context::interval(uint32_t interval){
+        gapi_asserts(m_window != nullptr, "Window is nullptr");
+        glfwSwapInterval(interval);
     }
 
-    bool shader::uniform(const std::string& n, float x, float y, float z, float w) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniform4f(uniform_location, x, y, z, w));
-        return true;
+    upload_context::~upload_context(){
+        if(m_thread.joinable()){
+            {
+                std::lock_guard lock(m_mutex);
+                m_stop = true;
+            }
+            m_signal.notify_all();
+            m_thread.join();
+        }
+
+        for(auto& done : m_finished){
+            gl(glDeleteSync(done.fence));
+        }
+
+        if(m_window) glfwDestroyWindow(m_window);
     }
 
-    bool shader::uniform(const std::string& n, const glm::vec2& v) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniform2fv(uniform_location, 1, glm::value_ptr(v)));
+    bool upload_context::init(){
+        gapi_asserts(m_shared != nullptr, "Shared window is nullptr");
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        m_window = glfwCreateWindow(1, 1, "", nullptr, m_shared);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+        gapi_asserts(m_window != nullptr, "Failed to create upload context");
+        if(!m_window) return false;
+
+        m_thread = std::thread([this]{ run(); });
         return true;
     }
 
-    bool shader::uniform(const std::string& n, const glm::vec3& v) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniform3fv(uniform_location, 1, glm::value_ptr(v)));
-        return true;
+    void upload_context::submit(std::function<void()> work, std::function<void()> publish){
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push_back({std::move(work), std::move(publish)});
+        }
+        m_signal.notify_one();
     }
 
-    bool shader::uniform(const std::string& n, const glm::vec4& v) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniform4fv(uniform_location, 1, glm::value_ptr(v)));
-        return true;
+    void upload_context::run(){
+        glfwMakeContextCurrent(m_window);
+        state_cache::make_current(&m_state);
+
+        for(;;){
+            job next;
+            {
+                std::unique_lock lock(m_mutex);
+                m_signal.wait(lock, [this]{ return m_stop || !m_jobs.empty(); });
+                if(m_stop) break;
+                next = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+
+            next.work();
+            GLsync fence = gl(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+            gl(glFlush());
+
+            std::lock_guard lock(m_mutex);
+            m_finished.push_back({fence, std::move(next.publish)});
+        }
+
+        state_cache::make_current(nullptr);
+        glfwMakeContextCurrent(nullptr);
     }
 
-    bool shader::uniform(const std::string& n, const glm::mat2& v) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniformMatrix2fv(uniform_location, 1, GL_FALSE, glm::value_ptr(v)));
-        return true;
+    uint32_t upload_context::poll(){
+        uint32_t published = 0;
+
+        for(;;){
+            finished done;
+            {
+                std::lock_guard lock(m_mutex);
+                if(m_finished.empty()) break;
+
+                GLenum status = gl(glClientWaitSync(m_finished.front().fence, 0, 0));
+                if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+                done = std::move(m_finished.front());
+                m_finished.pop_front();
+            }
+
+            gl(glDeleteSync(done.fence));
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            if(done.publish) done.publish();
+            published++;
+        }
+
+        return published;
     }
 
-    bool shader::uniform(const std::string& n, const glm::mat3& v) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniformMatrix3fv(uniform_location, 1, GL_FALSE, glm::value_ptr(v)));
-        return true;
+    void buffer_mirror::assign(const void* data, size_t size){
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_data.assign(bytes, bytes + size);
     }
 
-    bool shader::uniform(const std::string& n, const glm::mat4& v) const {
-        uint32_t uniform_location = validator(n);
-        if(uniform_location == -1) return false;
-        gl(glUniformMatrix4fv(uniform_location, 1, GL_FALSE, glm::value_ptr(v)));
-        return true;
+    void buffer_mirror::write(uint32_t id, size_t capacity, size_t offset, std::span<const std::byte> data){
+        gapi_asserts(offset + data.size() <= capacity, "Buffer update out of range");
+        if(offset + data.size() > capacity) return;
+
+        if(m_data.size() != capacity){
+            m_data.resize(capacity);
+            gl(glBindBuffer(GL_COPY_READ_BUFFER, id));
+            gl(glGetBufferSubData(GL_COPY_READ_BUFFER, 0, capacity, m_data.data()));
+        }
+
+        std::memcpy(m_data.data() + offset, data.data(), data.size());
+        m_dirty.add(offset, offset + data.size());
     }
 
-    texture_2d::texture_2d(std::filesystem::path path, TEXTURE_FILTER filter, TEXTURE_WRAP wrap,  bool flip){
-        m_path = path.string();
-        stbi_set_flip_vertically_on_load(flip);
-        m_data = stbi_load(m_path.c_str(), &m_width, &m_height, &m_channels, 0);
-        gapi_asserts(m_data == nullptr, "Failed to load texture data");
+    void buffer_mirror::flush(uint32_t id, size_t capacity, DRAW usage){
+        if(m_dirty.empty()) return;
+        gl(glBindBuffer(GL_COPY_WRITE_BUFFER, id));
 
-        GLenum internal_format = 0, data_format = 0;
-        if(m_channels == 4){
-            internal_format = GL_RGBA8;
-            data_format = GL_RGBA;
+        if(m_dirty.bytes() * 2 >= capacity){
+            GAPI_STAT(buffer_bytes, capacity);
+            gl(glBufferData(GL_COPY_WRITE_BUFFER, capacity, m_data.data(), static_cast<GLenum>(usage)));
         }
-        else if(m_channels == 3){
-            internal_format = GL_RGB8;
-            data_format = GL_RGB;
+        else{
+            GAPI_STAT(buffer_bytes, m_dirty.bytes());
+            for(const auto& range : m_dirty.ranges()){
+                gl(glBufferSubData(GL_COPY_WRITE_BUFFER, range.begin, range.end - range.begin, m_data.data() + range.begin));
+            }
         }
 
-        gapi_asserts(internal_format == 0 || data_format == 0, "Texture format not supported");
-
-        gl(glGenTextures(1, &m_id));
-        gl(glBindTexture(TEXTURE_2D, m_id));
-        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter));
-        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter));
-        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap));
-        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap));
-        gl(glTexImage2D(TEXTURE_2D, 0, internal_format, m_width, m_height, 0, data_format, GL_UNSIGNED_BYTE, m_data));
+        m_dirty.clear();
     }
 
-    texture_2d::~texture_2d(){
-        gl(glDeleteTextures(1, &m_id));
-        stbi_image_free(m_data);
+    vertex_buffer::vertex_buffer(const void* v, uint32_t s, DRAW t): m_size(s), m_usage(t) {
+        GAPI_STAT(created, 1);
+        GAPI_STAT(buffer_bytes, v ? s : 0);
+        gl(glGenBuffers(1, &m_id));
+        state_cache::current().bind_buffer(GL_ARRAY_BUFFER, m_id);
+        gl(glBufferData(GL_ARRAY_BUFFER, s, v, static_cast<GLenum>(t)));
+        if(v && t != DRAW_STATIC) m_mirror.assign(v, s);
     }
 
-    void texture_2d::bind(uint32_t slot) const {
-        gl(glActiveTexture(GL_TEXTURE0 + slot));
-        gl(glBindTexture(GL_TEXTURE_2D, m_id));
+    vertex_buffer::~vertex_buffer(){
+        GAPI_STAT(destroyed, 1);
+        state_cache::current().release_buffer(m_id);
+        gl(glDeleteBuffers(1, &m_id));
     }
 
-    void texture_2d::unbind() const {
-        gl(glBindTexture(GL_TEXTURE_2D, 0));
+    void vertex_buffer::bind() const{
+        state_cache::current().bind_buffer(GL_ARRAY_BUFFER, m_id);
     }
 
-    void api::init() {
-        gl(glEnable(GL_BLEND));
-        gl(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    void vertex_buffer::unbind() const{
     }
-    void api::draw(const std::shared_ptr<gapi::vertex_array>& va) {
-        auto& index_buffer = va->index();
-        gl(glDrawElements(GL_TRIANGLES, index_buffer->count(), GL_UNSIGNED_INT, nullptr));
+
+    void vertex_buffer::update(size_t offset, std::span<const std::byte> data){
+        m_mirror.write(m_id, m_size, offset, data);
     }
 
-    void api::clear() {
-        gl(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    void vertex_buffer::flush(){
+        m_mirror.flush(m_id, m_size, m_usage);
     }
 
-    void api::clear_color(float r, float g, float b, float a) {
-        gl(glClearColor(r, g, b, a));
+    index_buffer::index_buffer(const void* i, uint32_t count, gapi::INDEX type, DRAW t)
+        : m_count(count), m_type(type), m_size(static_cast<size_t>(count) * static_cast<uint32_t>(type)), m_usage(t) {
+        GAPI_STAT(created, 1);
+        GAPI_STAT(buffer_bytes, i ? m_size : 0);
+        gl(glGenBuffers(1, &m_id));
+        gl(glBindBuffer(GL_COPY_WRITE_BUFFER, m_id));
+        gl(glBufferData(GL_COPY_WRITE_BUFFER, m_size, i, static_cast<GLenum>(t)));
+        if(i && t != DRAW_STATIC) m_mirror.assign(i, m_size);
+    }
+
+    index_buffer::~index_buffer(){
+        GAPI_STAT(destroyed, 1);
+        state_cache::current().release_buffer(m_id);
+        gl(glDeleteBuffers(1, &m_id));
+    }
+
+    void index_buffer::bind() const {
+        state_cache::current().bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_id);
+    }
+
+    void index_buffer::unbind() const {
+    }
+
+    void index_buffer::update(size_t offset, std::span<const std::byte> data){
+        m_mirror.write(m_id, m_size, offset, data);
+    }
+
+    void index_buffer::flush(){
+        m_mirror.flush(m_id, m_size, m_usage);
+    }
+
+    stream_buffer::stream_buffer(uint32_t frame_size, uint32_t frames): m_frame_size(frame_size), m_frames(frames) {
+        const GLsizeiptr size = static_cast<GLsizeiptr>(m_frame_size) * m_frames;
+        m_fences.resize(m_frames, nullptr);
+        m_persistent = GLEW_ARB_buffer_storage;
+
+        GAPI_STAT(created, 1);
+        gl(glGenBuffers(1, &m_id));
+        gl(glBindBuffer(GL_COPY_WRITE_BUFFER, m_id));
+
+        if(m_persistent){
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            gl(glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags));
+            void* mapped = gl(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+            m_mapped = static_cast<uint8_t*>(mapped);
+            gapi_asserts(m_mapped != nullptr, "Failed to map stream buffer");
+        }
+        else{
+            gl(glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW));
+        }
+    }
+
+    stream_buffer::~stream_buffer(){
+        GAPI_STAT(destroyed, 1);
+        for(auto fence : m_fences){
+            if(fence){
+                gl(glDeleteSync(fence));
+            }
+        }
+
+        auto& state = state_cache::current();
+        state.release_buffer(m_id);
+        if(m_mapped){
+            gl(glBindBuffer(GL_COPY_WRITE_BUFFER, m_id));
+            gl(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+        }
+        gl(glDeleteBuffers(1, &m_id));
+    }
+
+    void stream_buffer::wait(uint32_t frame){
+        GLsync fence = m_fences[frame];
+        if(!fence) return;
+
+        GLenum status = gl(glClientWaitSync(fence, 0, 0));
+        while(status == GL_TIMEOUT_EXPIRED){
+            status = gl(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+        }
+
+        gl(glDeleteSync(fence));
+        m_fences[frame] = nullptr;
+    }
+
+    void stream_buffer::begin_frame(){
+        wait(m_frame);
+        m_head = 0;
+
+        if(!m_persistent){
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+            gl(glBindBuffer(GL_COPY_WRITE_BUFFER, m_id));
+            void* region = gl(glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(m_frame) * m_frame_size, m_frame_size, flags));
+            m_mapped = static_cast<uint8_t*>(region);
+            m_mapped_offset = m_frame * m_frame_size;
+        }
+    }
+
+    void stream_buffer::unmap(){
+        if(m_persistent || !m_mapped) return;
+
+        gl(glBindBuffer(GL_COPY_WRITE_BUFFER, m_id));
+        gl(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+        m_mapped = nullptr;
+    }
+
+    void stream_buffer::end_frame(){
+        gapi_asserts(m_persistent || !m_mapped, "Stream buffer frame ended while still mapped; call unmap() before drawing");
+        unmap();
+
+        m_fences[m_frame] = gl(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        m_frame = (m_frame + 1) % m_frames;
+    }
+
+    stream_buffer::allocation stream_buffer::allocate(uint32_t size, uint32_t alignment){
+        const uint32_t base = m_frame * m_frame_size;
+        uint32_t offset = (base + m_head + alignment - 1) / alignment * alignment;
+        if(m_mapped == nullptr || offset + size > base + m_frame_size){
+            gapi_asserts(false, "Stream buffer frame region exhausted or not mapped");
+            return {};
+        }
+
+        m_head = offset + size - base;
+        GAPI_STAT(buffer_bytes, size);
+        return {m_mapped + (offset - m_mapped_offset), offset, size};
+    }
+
+    vertex_array::vertex_array(){
+        GAPI_STAT(created, 1);
+        gl(glGenVertexArrays(1, &m_id));
+    }
+
+    vertex_array::~vertex_array(){
+        GAPI_STAT(destroyed, 1);
+        state_cache::current().release_vertex_array(m_id);
+        gl(glDeleteVertexArrays(1, &m_id));
+    }
+
+    void vertex_array::bind() const {
+        state_cache::current().bind_vertex_array(m_id);
+    }
+
+    void vertex_array::unbind() const {
+    }
+
+    static DATA_TYPE attribute_type(gapi::ATTRIBUTE type){
+        switch(type){
+            case gapi::ATTRIB_HALF:             return HALF;
+            case gapi::ATTRIB_BYTE:             return BYTE;
+            case gapi::ATTRIB_UBYTE:            return UBYTE;
+            case gapi::ATTRIB_SHORT:            return SHORT;
+            case gapi::ATTRIB_USHORT:           return USHORT;
+            case gapi::ATTRIB_INT:              return INT;
+            case gapi::ATTRIB_UINT:             return UINT;
+            case gapi::ATTRIB_INT_2_10_10_10:   return INT_2_10_10_10;
+            case gapi::ATTRIB_UINT_2_10_10_10:  return UINT_2_10_10_10;
+            default:                            return FLOAT;
+        }
+    }
+
+    void vertex_array::attributes(const gapi::buffer_layout& layout){
+        for(const auto& element : layout.elements())
+        {
+            const DATA_TYPE type = attribute_type(element.type);
+            const uint32_t column = gapi::attribute_size(element.type, element.component);
+            const uint32_t columns = column ? std::max(element.size / column, 1u) : 1;
+            for(uint32_t c = 0; c < columns; c++){
+                const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(element.offset + c * column));
+                gl(glEnableVertexAttribArray(m_attributes));
+                if(element.integer){
+                    gl(glVertexAttribIPointer(m_attributes, element.component, type, layout.stride(), offset));
+                }
+                else{
+                    gl(glVertexAttribPointer(m_attributes, element.component, type, element.normalized, layout.stride(), offset));
+                }
+                gl(glVertexAttribDivisor(m_attributes, element.divisor));
+                m_attributes++;
+            }
+        }
+    }
+
+    void vertex_array::emplace_vertex(const std::shared_ptr<gapi::vertex_buffer>& vb){
+        bind();
+        vb->bind();
+        attributes(vb->layout());
+        m_vertex_buffers.emplace_back(vb);
+    }
+
+    void vertex_array::emplace_index(const std::shared_ptr<gapi::index_buffer>& ib){
+        bind();
+        ib->bind();
+        m_index_buffer = ib;
+    }
+
+    void vertex_array::emplace_stream(const std::shared_ptr<stream_buffer>& stream, const gapi::buffer_layout& layout, gapi::INDEX type){
+        auto& state = state_cache::current();
+        bind();
+        state.bind_buffer(GL_ARRAY_BUFFER, stream->id());
+        attributes(layout);
+        state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, stream->id());
+        m_stream = stream;
+        m_stream_index = type;
+    }
+
+    geometry_pool::geometry_pool(const gapi::buffer_layout& layout, uint32_t vertex_capacity, uint32_t index_capacity, gapi::INDEX type)
+        : m_layout(layout), m_vertex_ranges(vertex_capacity), m_index_ranges(index_capacity) {
+        m_vertices = std::make_shared<vertex_buffer>(nullptr, vertex_capacity * m_layout.stride(), DRAW_DYNAMIC);
+        m_vertices->configure_layout(m_layout);
+        m_indices = std::make_shared<index_buffer>(nullptr, index_capacity, type, DRAW_DYNAMIC);
+        m_array = std::make_shared<vertex_array>();
+        m_array->emplace_vertex(m_vertices);
+        m_array->emplace_index(m_indices);
+    }
+
+    geometry_pool::mesh geometry_pool::allocate(const void* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count){
+        mesh m{m_vertex_ranges.allocate(vertex_count), vertex_count, m_index_ranges.allocate(index_count), index_count};
+        if(!m.valid()){
+            gapi_asserts(false, "Geometry pool exhausted");
+            release(m);
+            return {};
+        }
+
+        gapi_asserts(m_indices->type() == gapi::INDEX::U32 || vertex_count <= (1u << (8 * static_cast<uint32_t>(m_indices->type()))), "Mesh has too many vertices for the pool's index type");
+        const uint32_t stride = m_layout.stride();
+        const uint32_t index_size = static_cast<uint32_t>(m_indices->type());
+        m_staging.resize(static_cast<size_t>(index_count) * index_size);
+        gapi::convert_indices(indices, index_count, m_indices->type(), m_staging.data());
+
+        GAPI_STAT(buffer_bytes, static_cast<uint64_t>(vertex_count) * stride + m_staging.size());
+        gl(glBindBuffer(GL_COPY_WRITE_BUFFER, m_vertices->id()));
+        gl(glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(m.base_vertex) * stride, static_cast<GLsizeiptr>(vertex_count) * stride, vertices));
+        gl(glBindBuffer(GL_COPY_WRITE_BUFFER, m_indices->id()));
+        gl(glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(m.first_index) * index_size, m_staging.size(), m_staging.data()));
+        return m;
+    }
+
+    void geometry_pool::release(const mesh& m){
+        m_vertex_ranges.release(m.base_vertex, m.vertex_count);
+        m_index_ranges.release(m.first_index, m.index_count);
+    }
+
+    uniform_ring::uniform_ring(uint32_t frame_size, uint32_t frames): m_frames(frames) {
+        int32_t alignment{0};
+        gl(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+        m_alignment = std::max(alignment, 1);
+        m_frame_size = (frame_size + m_alignment - 1) / m_alignment * m_alignment;
+        m_staging.resize(m_frame_size);
+
+        GAPI_STAT(created, 1);
+        gl(glGenBuffers(1, &m_id));
+        gl(glBindBuffer(GL_UNIFORM_BUFFER, m_id));
+        gl(glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(m_frame_size) * m_frames, nullptr, GL_DYNAMIC_DRAW));
+    }
+
+    uniform_ring::~uniform_ring(){
+        GAPI_STAT(destroyed, 1);
+        gl(glDeleteBuffers(1, &m_id));
+    }
+
+    uniform_ring::allocation uniform_ring::allocate(uint32_t size, uint32_t binding){
+        uint32_t offset = (m_head + m_alignment - 1) / m_alignment * m_alignment;
+        if(offset + size > m_frame_size){
+            gapi_asserts(false, "Uniform ring frame region exhausted");
+            return {};
+        }
+
+        m_head = offset + size;
+        return {m_staging.data() + offset, {m_id, binding, m_frame * m_frame_size + offset, size}};
+    }
+
+    void uniform_ring::upload(){
+        if(m_head <= m_uploaded) return;
+        GAPI_STAT(buffer_bytes, m_head - m_uploaded);
+        gl(glBindBuffer(GL_UNIFORM_BUFFER, m_id));
+        gl(glBufferSubData(GL_UNIFORM_BUFFER, m_frame * m_frame_size + m_uploaded, m_head - m_uploaded, m_staging.data() + m_uploaded));
+        m_uploaded = m_head;
+    }
+
+    void uniform_ring::next_frame(){
+        m_frame = (m_frame + 1) % m_frames;
+        m_head = 0;
+        m_uploaded = 0;
+    }
+
+    static uint32_t uniform_size(GLenum type){
+        switch(type){
+            case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:     return 4;
+            case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2:    return 8;
+            case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3:    return 12;
+            case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4:    return 16;
+            case GL_FLOAT_MAT2:                                                 return 16;
+            case GL_FLOAT_MAT3:                                                 return 36;
+            case GL_FLOAT_MAT4:                                                 return 64;
+            default:                                                            return 4;
+        }
+    }
+
+    static thread_local program_cache* s_current_programs{nullptr};
+
+    struct program_binary_header{
+        static constexpr uint32_t MAGIC = 0x43504750; // "PGPC"
+        uint32_t magic{MAGIC};
+        uint32_t format{0};
+        uint64_t key{0};
+        uint64_t length{0};
+    };
+
+    program_cache::program_cache(std::filesystem::path directory, const info& gl_info): m_directory(std::move(directory)){
+        m_salt = gapi::hash64(gl_info.vendor() + '\n' + gl_info.renderer() + '\n' + gl_info.version());
+
+        GLint formats = 0;
+        if(GLEW_ARB_get_program_binary){
+            gl(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+        m_enabled = formats > 0 && !error;
+        if(formats > 0 && error){
+            gapi_debug_msg("Program cache disabled: ", error.message());
+        }
+    }
+
+    program_cache* program_cache::current(){
+        return s_current_programs;
+    }
+
+    void program_cache::make_current(program_cache* cache){
+        s_current_programs = cache;
+    }
+
+    std::filesystem::path program_cache::entry(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return m_directory / name;
+    }
+
+    uint64_t program_cache::key(const std::unordered_map<SHADER_TYPE, std::string>& sources) const {
+        std::vector<std::pair<uint32_t, std::string_view>> stages;
+        stages.reserve(sources.size());
+        for(auto& source : sources) stages.emplace_back(static_cast<uint32_t>(source.first), source.second);
+        std::sort(stages.begin(), stages.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+
+        uint64_t value = m_salt;
+        for(auto& [type, source] : stages){
+            value = gapi::hash64(std::string_view(reinterpret_cast<const char*>(&type), sizeof(type)), value);
+            value = gapi::hash64(source, value);
+        }
+        return value;
+    }
+
+    uint32_t program_cache::load(uint64_t key){
+        if(!m_enabled) return 0;
+        const auto start = std::chrono::steady_clock::now();
+        const std::filesystem::path path = entry(key);
+
+        std::error_code error;
+        const uintmax_t size = std::filesystem::file_size(path, error);
+        program_binary_header header{};
+        std::ifstream file(path, std::ios::binary);
+        if(error || size < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+           header.magic != program_binary_header::MAGIC || header.key != key || header.length != size - sizeof(header)){
+            m_counters.misses++;
+            return 0;
+        }
+
+        std::vector<char> binary(header.length);
+        if(!file.read(binary.data(), static_cast<std::streamsize>(binary.size()))){
+            m_counters.misses++;
+            return 0;
+        }
+
+        uint32_t program = gl(glCreateProgram());
+        gl(glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size())));
+        GLint linked = GL_FALSE;
+        gl(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+        m_counters.load_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // Drivers reject binaries from other builds; the entry is stale and the caller compiles from source.
+        if(linked == GL_FALSE){
+            gl(glDeleteProgram(program));
+            std::filesystem::remove(path, error);
+            m_counters.rejected++;
+            m_counters.misses++;
+            return 0;
+        }
+
+        m_counters.hits++;
+        return program;
+    }
+
+    void program_cache::store(uint64_t key, uint32_t program, double compile_ms){
+        m_counters.compile_ms += compile_ms;
+        if(!m_enabled || program == 0) return;
+
+        GLint length = 0;
+        gl(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+        if(length <= 0) return;
+
+        std::vector<char> binary(length);
+        GLenum format = GL_NONE;
+        gl(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+        program_binary_header header{};
+        header.format = format;
+        header.key = key;
+        header.length = static_cast<uint64_t>(length);
+
+        // Written aside and renamed so an interrupted run never leaves a torn entry behind.
+        const std::filesystem::path path = entry(key);
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+
+        std::error_code error;
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(binary.data(), length);
+            if(!file){
+                file.close();
+                std::filesystem::remove(temporary, error);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporary, path, error);
+        if(error) std::filesystem::remove(temporary, error);
+    }
+
+    void program_cache::clear(){
+        std::error_code error;
+        for(auto& file : std::filesystem::directory_iterator(m_directory, error)){
+            if(file.path().extension() == ".bin") std::filesystem::remove(file.path(), error);
+        }
+    }
+
+    void shader::reflect(){
+        m_uniforms.clear();
+
+        int32_t count{0}, max_length{0};
+        gl(glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count));
+        gl(glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length));
+        std::vector<char> name(std::max(max_length, 1));
+        m_uniforms.reserve(count);
+
+        uint32_t offset = 0;
+        for(int32_t i = 0; i < count; i++){
+            GLsizei length{0};
+            GLint size{0};
+            GLenum type{GL_NONE};
+            gl(glGetActiveUniform(m_id, i, max_length, &length, &size, &type, name.data()));
+
+            int32_t location = gl(glGetUniformLocation(m_id, name.data()));
+            if(location == -1) continue;
+
+            std::string_view uniform_name(name.data(), length);
+            const uint32_t element = uniform_size(type);
+            const bool array = uniform_name.size() > 3 && uniform_name.substr(uniform_name.size() - 3) == "[0]";
+            if(!array){
+                m_uniforms.push_back({gapi::hash(uniform_name), location, type, size, offset, element});
+                offset += element;
+                continue;
+            }
+
+            // Arrays answer to "name", "name[0]" .. "name[size - 1]"; "name" aliases element 0 and shares its shadow.
+            uniform_name.remove_suffix(3);
+            m_uniforms.push_back({gapi::hash(uniform_name), location, type, size, offset, element});
+            std::string element_name(uniform_name);
+            for(int32_t e = 0; e < size; e++){
+                element_name.resize(uniform_name.size());
+                element_name += '[' + std::to_string(e) + ']';
+                m_uniforms.push_back({gapi::hash(element_name), location + e, type, size - e, offset + e * element, element});
+            }
+            offset += element * static_cast<uint32_t>(size);
+        }
+
+        std::sort(m_uniforms.begin(), m_uniforms.end(), [](const uniform_info& a, const uniform_info& b){ return a.hash < b.hash; });
+        gapi_asserts(std::adjacent_find(m_uniforms.begin(), m_uniforms.end(), [](const uniform_info& a, const uniform_info& b){ return a.hash == b.hash; }) == m_uniforms.end(), "Uniform name hash collision");
+
+        m_values.assign(offset, 0);
+        m_cached.assign(m_uniforms.size(), 0);
+    }
+
+    bool shader::changed(gapi::uniform_handle h, const void* v, uint32_t size) const {
+        const auto& info = m_uniforms[h.index];
+        uint8_t* value = m_values.data() + info.offset;
+        size = std::min(size, info.size);
+
+        if(m_cached[h.index] && std::memcmp(value, v, size) == 0) return false;
+        GAPI_STAT(uniform_sets, 1);
+        std::memcpy(value, v, size);
+        m_cached[h.index] = 1;
+        return true;
+    }
+
+    bool shader::block(std::string_view n, uint32_t binding) const {
+        std::string block_name(n);
+        uint32_t index = gl(glGetUniformBlockIndex(m_id, block_name.c_str()));
+        if(index == GL_INVALID_INDEX){
+            gapi_debug_msg("Uniform block not found: ", block_name);
+            return false;
+        }
+
+        gl(glUniformBlockBinding(m_id, index, binding));
+        return true;
+    }
+
+    gapi::uniform_handle shader::handle(uint32_t name_hash) const {
+        auto it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name_hash, [](const uniform_info& info, uint32_t value){ return info.hash < value; });
+        if(it == m_uniforms.end() || it->hash != name_hash) return {};
+        return {static_cast<int32_t>(it - m_uniforms.begin())};
+    }
+
+    gapi::uniform_handle shader::handle(std::string_view n) const {
+        gapi::uniform_handle h = handle(gapi::hash(n));
+        if(!h.valid()) {
+            gapi_debug_msg("Uniform not found: ", n);
+        }
+
+        return h;
+    }
+
+    uint32_t shader::uniformloc(const std::string& n) const {
+        gapi::uniform_handle h = handle(n);
+        return h.valid() ? m_uniforms[h.index].location : -1;
+    }
+
+    static bool parallel_compile(){
+        return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+    }
+
+    void shader::compile(std::unordered_map<SHADER_TYPE, std::string> sources, bool deferred){
+        program_cache* cache = program_cache::current();
+        const uint64_t key = cache ? cache->key(sources) : 0;
+        if(cache){
+            if(uint32_t program = cache->load(key); program != 0){
+                GAPI_STAT(created, 1);
+                m_id = program;
+                reflect();
+                return;
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        uint32_t shader_program = gl(glCreateProgram());
+        if(shader_program == GL_FALSE) return;
+        GAPI_STAT(created, 1);
+
+        if(cache && cache->enabled()){
+            gl(glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+        }
+
+        m_build = std::make_unique<build>();
+        m_build->program = shader_program;
+        m_build->cache = cache;
+        m_build->key = key;
+        m_build->start = start;
+        m_build->shaders.reserve(sources.size());
+
+        // Statuses are only queried in finish(), so the driver is free to compile every stage and link in the background.
+        for(auto& source : sources){
+            SHADER_TYPE type = source.first;
+            const std::string& src = source.second;
+
+            uint32_t shader_id = gl(glCreateShader(static_cast<GLenum>(type)));
+            const char* src_cstr = src.c_str();
+
+            gl(glShaderSource(shader_id, 1, &src_cstr, nullptr));
+            gl(glCompileShader(shader_id));
+            gl(glAttachShader(shader_program, shader_id));
+            m_build->shaders.push_back(shader_id);
+        }
+
+        gl(glLinkProgram(shader_program));
+        if(!deferred) finish();
+    }
+
+    void shader::finish(){
+        if(!m_build) return;
+        std::unique_ptr<build> pending = std::move(m_build);
+        const uint32_t shader_program = pending->program;
+
+        for(auto& shader_id : pending->shaders){
+            int32_t result{0};
+            gl(glGetShaderiv(shader_id, GL_COMPILE_STATUS, &result));
+
+            if(result == GL_FALSE){
+                int message_length = 0;
+                gl(glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &message_length));
+                std::vector<char> compile_error_message(message_length + 1);
+                gl(glGetShaderInfoLog(shader_id, message_length, &message_length, &compile_error_message[0]));
+                gapi_debug_msg("Shader compilation error: ", compile_error_message.data());
+            }
+        }
+
+        int result{0};
+        gl(glGetProgramiv(shader_program, GL_LINK_STATUS, &result));
+        const bool linked = result != GL_FALSE;
+
+        if(!linked){
+            int message_length = 0;
+            gl(glGetProgramiv(shader_program, GL_INFO_LOG_LENGTH, &message_length));
+            std::vector<char> link_error_message(message_length + 1);
+            gl(glGetProgramInfoLog(shader_program, message_length, &message_length, &link_error_message[0]));
+            gapi_debug_msg("Shader linking error: ", link_error_message.data());
+        }
+
+        gl(glValidateProgram(shader_program));
+        gl(glGetProgramiv(shader_program, GL_VALIDATE_STATUS, &result));
+
+        if(result == GL_FALSE){
+            int message_length = 0;
+            gl(glGetProgramiv(shader_program, GL_INFO_LOG_LENGTH, &message_length));
+            std::vector<char> validate_error_message(message_length + 1);
+            gl(glGetProgramInfoLog(shader_program, message_length, &message_length, &validate_error_message[0]));
+            gapi_debug_msg("Shader validation error: ", validate_error_message.data());
+        }
+
+        for(auto& shader : pending->shaders){
+            gl(glDetachShader(shader_program, shader));
+            gl(glDeleteShader(shader));
+        }
+
+        m_id = shader_program;
+        reflect();
+
+        if(pending->cache && linked) pending->cache->store(pending->key, shader_program, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pending->start).count());
+    }
+
+    bool shader::ready(){
+        if(!m_build) return true;
+
+        // Without parallel_shader_compile there is nothing to poll; querying the link status blocks either way.
+        if(parallel_compile()){
+            int32_t done{GL_FALSE};
+            gl(glGetProgramiv(m_build->program, GL_COMPLETION_STATUS_KHR, &done));
+            if(done == GL_FALSE) return false;
+        }
+
+        finish();
+        return true;
+    }
+
+    void shader::wait(){
+        finish();
+    }
+
+    std::string shader::read_file(const std::filesystem::path& file_path) const{
+        std::string result;
+        std::ifstream infile(file_path, std::ios::in | std::ios::binary);
+        if(infile){
+            infile.seekg(0, std::ios::end);
+            result.resize(infile.tellg());
+            infile.seekg(0, std::ios::beg);
+            infile.read(&result[0], result.size());
+            infile.close();
+            return result;
+        }
+
+        gapi_debug_msg("Failed to read file: ", file_path.string());
+        return "";
+    }
+
+    static SHADER_TYPE shader_type_from_string(const std::string &type){
+        if(type == "vertex")                          return SHADER_TYPE::SHADER_VERTEX;
+        if(type == "fragment" || type == "pixel")     return SHADER_TYPE::SHADER_FRAGMENT;
+        if(type == "geometry")                        return SHADER_TYPE::SHADER_GEOMETRY;
+        gapi_asserts(false, "Invalid shader type specified");
+        return SHADER_TYPE::SHADER_NONE;
+    }
+
+    // Splits on #type lines; header is prepended to every stage.
+    static std::unordered_map<SHADER_TYPE, std::string> split_stages(const std::string& src, const std::string& header){
+        std::unordered_map<SHADER_TYPE,std::string> shader_sources;
+        const char *type_token = "#type";
+        size_t type_token_length = strlen(type_token);
+        size_t pos = src.find(type_token, 0);
+
+        while(pos != std::string::npos){
+            size_t eol = src.find_first_of("\r\n", pos);
+            gapi_asserts(eol != std::string::npos, "Syntax error, Did you forget to add shader type line #type declaration");
+            if(eol == std::string::npos) break;
+            size_t begin = pos + type_token_length + 1;
+            std::string type = src.substr(begin, eol - begin);
+            gapi_asserts(type == "vertex" || type == "fragment" || type == "pixel" || type == "geometry", "Invalid shader type specified");
+            size_t next_line_pos = src.find_first_not_of("\r\n", eol);
+            pos = src.find(type_token, next_line_pos);
+            std::string body = next_line_pos == std::string::npos ? std::string{} : src.substr(next_line_pos, pos - next_line_pos);
+            shader_sources[shader_type_from_string(type)] = header + body;
+        }
+
+        return shader_sources;
+    }
+
+    std::unordered_map<SHADER_TYPE, std::string> shader::pre_process(const std::string& src) const {
+        return split_stages(src, {});
+    }
+
+    // The macro of a classic guard: the first two directives are #ifndef X and #define X.
+    static std::string include_guard(const std::string& text){
+        static constexpr const char* expected[2] = {"ifndef", "define"};
+        std::istringstream in(text);
+        std::string line, names[2];
+        int32_t found = 0;
+
+        while(found < 2 && std::getline(in, line)){
+            std::istringstream words(line);
+            std::string word;
+            if(!(words >> word) || word.rfind("//", 0) == 0) continue;
+            if(word[0] != '#') return {};
+            word = word.size() > 1 ? word.substr(1) : std::string{};
+            if(word.empty()) words >> word;
+            if(word != expected[found] || !(words >> names[found])) return {};
+            found++;
+        }
+
+        return found == 2 && names[0] == names[1] ? names[0] : std::string{};
+    }
+
+    static std::string stage_header(const std::string& version, const shader_defines& defines){
+        std::string header = version + '\n';
+        for(auto& [name, value] : defines){
+            header += "#define " + name;
+            if(!value.empty()) header += ' ' + value;
+            header += '\n';
+        }
+        return header;
+    }
+
+    static std::string_view trim(std::string_view s){
+        const size_t begin = s.find_first_not_of(" \t\r");
+        if(begin == std::string_view::npos) return {};
+        return s.substr(begin, s.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    shader_preprocessor::shader_preprocessor(const info& gl_info, std::vector<std::filesystem::path> include_paths):
+        m_version(gl_info.language()), m_include_paths(std::move(include_paths)){
+    }
+
+    const std::string* shader_preprocessor::read(const std::filesystem::path& path){
+        const std::string key = path.string();
+        if(auto it = m_files.find(key); it != m_files.end()) return &it->second;
+
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if(!file) return nullptr;
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return &m_files.emplace(key, std::move(content)).first->second;
+    }
+
+    std::filesystem::path shader_preprocessor::resolve(const std::string& name, const std::filesystem::path& from) const {
+        std::error_code error;
+        std::filesystem::path local = from.parent_path() / name;
+        if(std::filesystem::is_regular_file(local, error)) return local.lexically_normal();
+
+        for(auto& directory : m_include_paths){
+            std::filesystem::path candidate = directory / name;
+            if(std::filesystem::is_regular_file(candidate, error)) return candidate.lexically_normal();
+        }
+        return {};
+    }
+
+    void shader_preprocessor::expand(const std::string& text, const std::filesystem::path& path, expansion& state, std::string& out){
+        const size_t index = static_cast<size_t>(std::find(m_sources.begin(), m_sources.end(), path) - m_sources.begin());
+        if(index == m_sources.size()) m_sources.push_back(path);
+        state.stack.push_back(path.string());
+
+        size_t begin = 0;
+        uint32_t line = 0;
+        while(begin < text.size()){
+            size_t end = text.find('\n', begin);
+            if(end == std::string::npos) end = text.size();
+            const std::string_view current(text.data() + begin, end - begin);
+            begin = end + 1;
+            line++;
+
+            std::string_view directive = trim(current);
+            if(directive.empty() || directive[0] != '#'){
+                out.append(current);
+                out += '\n';
+                continue;
+            }
+
+            directive = trim(directive.substr(1));
+            const std::string_view word = directive.substr(0, directive.find_first_of(" \t"));
+            const std::string_view args = trim(directive.substr(word.size()));
+
+            if(word == "version"){
+                out += '\n';
+            }
+            else if(word == "pragma" && args == "once"){
+                state.once.insert(path.string());
+                out += '\n';
+            }
+            else if(word == "type"){
+                // Each stage is compiled on its own, so guarded files must be expanded again for it.
+                state.once.clear();
+                state.guards.clear();
+                out.append(current);
+                out += "\n#line " + std::to_string(line + 1) + ' ' + std::to_string(index) + '\n';
+            }
+            else if(word == "include"){
+                const size_t close = args.size() > 1 ? args.find(args[0] == '<' ? '>' : '"', 1) : std::string_view::npos;
+                if((args.empty() || (args[0] != '"' && args[0] != '<')) || close == std::string_view::npos){
+                    gapi_debug_msg("Shader preprocessor error: malformed #include in ", path.string());
+                    out += "#error malformed #include\n";
+                    continue;
+                }
+
+                const std::string name(args.substr(1, close - 1));
+                const std::filesystem::path file = resolve(name, path);
+                const std::string* content = file.empty() ? nullptr : read(file);
+                if(!content){
+                    gapi_debug_msg("Shader include not found: ", name);
+                    out += "#error include not found: " + name + '\n';
+                    continue;
+                }
+
+                const std::string key = file.string();
+                if(std::find(state.stack.begin(), state.stack.end(), key) != state.stack.end()){
+                    gapi_debug_msg("Shader preprocessor error: recursive #include of ", key);
+                    out += "#error recursive include: " + name + '\n';
+                    continue;
+                }
+
+                const std::string guard = include_guard(*content);
+                if(state.once.count(key) || (!guard.empty() && state.guards.count(guard))){
+                    out += '\n';
+                    continue;
+                }
+                if(!guard.empty()) state.guards.insert(guard);
+
+                const size_t source = static_cast<size_t>(std::find(m_sources.begin(), m_sources.end(), file) - m_sources.begin());
+                out += "#line 1 " + std::to_string(source) + '\n';
+                expand(*content, file, state, out);
+                out += "#line " + std::to_string(line + 1) + ' ' + std::to_string(index) + '\n';
+            }
+            else{
+                out.append(current);
+                out += '\n';
+            }
+        }
+
+        state.stack.pop_back();
+    }
+
+    std::unordered_map<SHADER_TYPE, std::string> shader_preprocessor::process(const std::filesystem::path& path, const shader_defines& defines){
+        m_sources.clear();
+        const std::string* text = read(path);
+        if(!text){
+            gapi_debug_msg("Failed to read file: ", path.string());
+            return {};
+        }
+
+        expansion state;
+        std::string expanded;
+        expanded.reserve(text->size());
+        expand(*text, path, state, expanded);
+        return split_stages(expanded, stage_header(m_version, defines));
+    }
+
+    std::unordered_map<SHADER_TYPE, std::string> shader_preprocessor::process_source(const std::string& source, const shader_defines& defines){
+        m_sources.clear();
+        expansion state;
+        std::string expanded;
+        expanded.reserve(source.size());
+        expand(source, {}, state, expanded);
+        return split_stages(expanded, stage_header(m_version, defines));
+    }
+
+    shader_variants::shader_variants(std::string sname, std::filesystem::path path, std::shared_ptr<shader_preprocessor> preprocessor, SHADER_BUILD mode):
+        m_name(std::move(sname)), m_path(std::move(path)), m_preprocessor(std::move(preprocessor)), m_mode(mode){
+        gapi_asserts(m_preprocessor != nullptr, "Shader variants need a preprocessor");
+    }
+
+    uint64_t shader_variants::key(const shader_defines& defines) const {
+        uint64_t value = gapi::hash64(m_path.string());
+        for(auto& [name, define] : defines){
+            value = gapi::hash64(std::string_view("\n", 1), value);
+            value = gapi::hash64(name, value);
+            value = gapi::hash64(std::string_view("=", 1), value);
+            value = gapi::hash64(define, value);
+        }
+        return value;
+    }
+
+    std::shared_ptr<shader> shader_variants::get(const shader_defines& defines){
+        const uint64_t k = key(defines);
+        if(auto it = m_variants.find(k); it != m_variants.end()) return it->second;
+
+        std::string variant = m_name;
+        if(!defines.empty()){
+            variant += '[';
+            for(auto& [name, define] : defines) variant += name + (define.empty() ? "" : "=" + define) + ',';
+            variant.back() = ']';
+        }
+
+        auto program = std::make_shared<shader>(variant, m_preprocessor->process(m_path, defines), m_mode);
+        m_variants.emplace(k, program);
+        return program;
+    }
+
+    shader::shader(const std::string& sname, const std::filesystem::path& path, SHADER_BUILD mode){
+        if(!std::filesystem::exists(path)){
+            gapi_debug_msg("Shader parse error: ", "Shader file does not exist");
+            return;
+        }
+
+        std::string source = read_file(path);
+        auto shader_sources = pre_process(source);
+        compile(shader_sources, mode == SHADER_BUILD::DEFERRED);
+        m_name = sname;
+    }
+
+    shader::shader(const std::string& sname, const std::filesystem::path& vertex, const std::filesystem::path& fragment, SHADER_BUILD mode){
+        if(!std::filesystem::exists(vertex) || !std::filesystem::exists(fragment)){
+            gapi_debug_msg("Shader parse error: ", "Shader file does not exist");
+            return;
+        }
+
+        std::string vertex_source = read_file(vertex);
+        std::string fragment_source = read_file(fragment);
+        std::unordered_map<SHADER_TYPE, std::string> shader_sources = {
+            {SHADER_VERTEX, vertex_source},
+            {SHADER_FRAGMENT, fragment_source}
+        };
+        compile(shader_sources, mode == SHADER_BUILD::DEFERRED);
+        m_name = sname;
+    }
+
+    shader::shader(const std::string& sname, std::unordered_map<SHADER_TYPE, std::string> sources, SHADER_BUILD mode){
+        if(sources.empty()){
+            gapi_debug_msg("Shader parse error: ", "No shader stages");
+            return;
+        }
+
+        compile(std::move(sources), mode == SHADER_BUILD::DEFERRED);
+        m_name = sname;
+    }
+
+    shader::~shader(){
+        if(m_id || m_build) GAPI_STAT(destroyed, 1);
+        if(m_build){
+            for(auto& shader : m_build->shaders){
+                gl(glDeleteShader(shader));
+            }
+            gl(glDeleteProgram(m_build->program));
+        }
+        state_cache::current().release_program(m_id);
+        gl(glDeleteProgram(m_id));
+    }
+
+    void shader::bind() const {
+        gapi_asserts(!m_build, "Shader bound before its deferred build finished");
+        state_cache::current().bind_program(m_id);
+    }
+
+    void shader::unbind() const {
+    }
+
+    bool shader::uniform(const std::string& n, uint32_t v) const {
+        return uniform(handle(n), v);
+    }
+
+    bool shader::uniform(const std::string& n, float v) const {
+        return uniform(handle(n), v);
+    }
+
+    bool shader::uniform(const std::string& n, float x, float y) const {
+        return uniform(handle(n), glm::vec2(x, y));
+    }
+
+    bool shader::uniform(const std::string& n, float x, float y, float z) const {
+        return uniform(handle(n), glm::vec3(x, y, z));
+    }
+
+    bool shader::uniform(const std::string& n, float x, float y, float z, float w) const {
+        return uniform(handle(n), glm::vec4(x, y, z, w));
+    }
+
+    bool shader::uniform(const std::string& n, const glm::vec2& v) const {
+        return uniform(handle(n), v);
+    }
+
+    bool shader::uniform(const std::string& n, const glm::vec3& v) const {
+        return uniform(handle(n), v);
+    }
+
+    bool shader::uniform(const std::string& n, const glm::vec4& v) const {
+        return uniform(handle(n), v);
+    }
+
+    bool shader::uniform(const std::string& n, const glm::mat2& v) const {
+        return uniform(handle(n), v);
+    }
+
+    bool shader::uniform(const std::string& n, const glm::mat3& v) const {
+        return uniform(handle(n), v);
+    }
+
+    bool shader::uniform(const std::string& n, const glm::mat4& v) const {
+        return uniform(handle(n), v);
+    }
+
+    bool shader::uniform(gapi::uniform_handle h, uint32_t v) const {
+        if(!h.valid()) return false;
+        if(!changed(h, &v, sizeof(v))) return true;
+        gl(glUniform1i(m_uniforms[h.index].location, v));
+        return true;
+    }
+
+    bool shader::uniform(gapi::uniform_handle h, float v) const {
+        if(!h.valid()) return false;
+        if(!changed(h, &v, sizeof(v))) return true;
+        gl(glUniform1f(m_uniforms[h.index].location, v));
+        return true;
+    }
+
+    bool shader::uniform(gapi::uniform_handle h, const glm::vec2& v) const {
+        if(!h.valid()) return false;
+        if(!changed(h, glm::value_ptr(v), sizeof(v))) return true;
+        gl(glUniform2fv(m_uniforms[h.index].location, 1, glm::value_ptr(v)));
+        return true;
+    }
+
+    bool shader::uniform(gapi::uniform_handle h, const glm::vec3& v) const {
+        if(!h.valid()) return false;
+        if(!changed(h, glm::value_ptr(v), sizeof(v))) return true;
+        gl(glUniform3fv(m_uniforms[h.index].location, 1, glm::value_ptr(v)));
+        return true;
+    }
+
+    bool shader::uniform(gapi::uniform_handle h, const glm::vec4& v) const {
+        if(!h.valid()) return false;
+        if(!changed(h, glm::value_ptr(v), sizeof(v))) return true;
+        gl(glUniform4fv(m_uniforms[h.index].location, 1, glm::value_ptr(v)));
+        return true;
+    }
+
+    bool shader::uniform(gapi::uniform_handle h, const glm::mat2& v) const {
+        if(!h.valid()) return false;
+        if(!changed(h, glm::value_ptr(v), sizeof(v))) return true;
+        gl(glUniformMatrix2fv(m_uniforms[h.index].location, 1, GL_FALSE, glm::value_ptr(v)));
+        return true;
+    }
+
+    bool shader::uniform(gapi::uniform_handle h, const glm::mat3& v) const {
+        if(!h.valid()) return false;
+        if(!changed(h, glm::value_ptr(v), sizeof(v))) return true;
+        gl(glUniformMatrix3fv(m_uniforms[h.index].location, 1, GL_FALSE, glm::value_ptr(v)));
+        return true;
+    }
+
+    bool shader::uniform(gapi::uniform_handle h, const glm::mat4& v) const {
+        if(!h.valid()) return false;
+        if(!changed(h, glm::value_ptr(v), sizeof(v))) return true;
+        gl(glUniformMatrix4fv(m_uniforms[h.index].location, 1, GL_FALSE, glm::value_ptr(v)));
+        return true;
+    }
+
+    image_data decode_image(const std::filesystem::path& path, bool flip){
+        image_data image{};
+        image.pixels.reset(stbi_load(path.string().c_str(), &image.width, &image.height, &image.channels, 0));
+        gapi_asserts(image.valid(), "Failed to load texture data");
+        if(!image.valid() || !flip) return image;
+
+        const size_t pitch = size_t(image.width) * image.channels;
+        uint8_t* pixels = image.pixels.get();
+        std::vector<uint8_t> row(pitch);
+        for(int32_t y = 0; y < image.height / 2; y++){
+            uint8_t* top = pixels + y * pitch;
+            uint8_t* bottom = pixels + (image.height - 1 - y) * pitch;
+            std::memcpy(row.data(), top, pitch);
+            std::memcpy(top, bottom, pitch);
+            std::memcpy(bottom, row.data(), pitch);
+        }
+        return image;
+    }
+
+    void generate_mips(image_data& image, const gmip::options& options){
+        if(!image.valid()) return;
+        image.mips = gmip::build_chain(image.pixels.get(), image.width, image.height, image.channels, options);
+    }
+
+    image_data allocate_image(int32_t width, int32_t height, int32_t channels){
+        image_data image{};
+        image.width = width;
+        image.height = height;
+        image.channels = channels;
+        image.pixels = std::unique_ptr<uint8_t, void(*)(void*)>(new uint8_t[size_t(width) * height * channels](), [](void* p){ delete[] static_cast<uint8_t*>(p); });
+        return image;
+    }
+
+    template<typename T>
+    static T read(const uint8_t* bytes, size_t offset){
+        T value;
+        std::memcpy(&value, bytes + offset, sizeof(T));
+        return value;
+    }
+
+    static compressed_format vk_format(uint32_t f){
+        switch(f){
+            case 131: return {GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 4, 4, 8, 3};
+            case 132: return {GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, 4, 4, 8, 3};
+            case 133: return {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 4, 4, 8, 4};
+            case 134: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 4, 4, 8, 4};
+            case 135: return {GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 4, 4, 16, 4};
+            case 136: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, 4, 4, 16, 4};
+            case 137: return {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 4, 4, 16, 4};
+            case 138: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 4, 4, 16, 4};
+            case 139: return {GL_COMPRESSED_RED_RGTC1, 4, 4, 8, 1};
+            case 140: return {GL_COMPRESSED_SIGNED_RED_RGTC1, 4, 4, 8, 1};
+            case 141: return {GL_COMPRESSED_RG_RGTC2, 4, 4, 16, 2};
+            case 142: return {GL_COMPRESSED_SIGNED_RG_RGTC2, 4, 4, 16, 2};
+            case 143: return {GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 4, 4, 16, 3};
+            case 144: return {GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 4, 4, 16, 3};
+            case 145: return {GL_COMPRESSED_RGBA_BPTC_UNORM, 4, 4, 16, 4};
+            case 146: return {GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 4, 4, 16, 4};
+            case 147: return {GL_COMPRESSED_RGB8_ETC2, 4, 4, 8, 3};
+            case 148: return {GL_COMPRESSED_SRGB8_ETC2, 4, 4, 8, 3};
+            case 149: return {GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, 4, 4, 8, 4};
+            case 150: return {GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2, 4, 4, 8, 4};
+            case 151: return {GL_COMPRESSED_RGBA8_ETC2_EAC, 4, 4, 16, 4};
+            case 152: return {GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, 4, 4, 16, 4};
+            case 153: return {GL_COMPRESSED_R11_EAC, 4, 4, 8, 1};
+            case 154: return {GL_COMPRESSED_SIGNED_R11_EAC, 4, 4, 8, 1};
+            case 155: return {GL_COMPRESSED_RG11_EAC, 4, 4, 16, 2};
+            case 156: return {GL_COMPRESSED_SIGNED_RG11_EAC, 4, 4, 16, 2};
+            default: break;
+        }
+
+        // VK_FORMAT_ASTC_4x4 .. 12x12 interleave UNORM/SRGB and follow the GL enum order.
+        if(f >= 157 && f <= 184){
+            constexpr uint32_t blocks[14][2] = {{4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+            const uint32_t i = (f - 157) / 2;
+            const uint32_t base = (f - 157) % 2 ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR : GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+            return {base + i, blocks[i][0], blocks[i][1], 16, 4};
+        }
+
+        return {};
+    }
+
+    static compressed_format dxgi_format(uint32_t f){
+        switch(f){
+            case 71: return {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 4, 4, 8, 4};
+            case 72: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 4, 4, 8, 4};
+            case 74: return {GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 4, 4, 16, 4};
+            case 75: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, 4, 4, 16, 4};
+            case 77: return {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 4, 4, 16, 4};
+            case 78: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 4, 4, 16, 4};
+            case 80: return {GL_COMPRESSED_RED_RGTC1, 4, 4, 8, 1};
+            case 81: return {GL_COMPRESSED_SIGNED_RED_RGTC1, 4, 4, 8, 1};
+            case 83: return {GL_COMPRESSED_RG_RGTC2, 4, 4, 16, 2};
+            case 84: return {GL_COMPRESSED_SIGNED_RG_RGTC2, 4, 4, 16, 2};
+            case 95: return {GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 4, 4, 16, 3};
+            case 96: return {GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 4, 4, 16, 3};
+            case 98: return {GL_COMPRESSED_RGBA_BPTC_UNORM, 4, 4, 16, 4};
+            case 99: return {GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 4, 4, 16, 4};
+            default: return {};
+        }
+    }
+
+    static constexpr uint32_t fourcc(const char (&code)[5]){
+        return uint32_t(uint8_t(code[0])) | (uint32_t(uint8_t(code[1])) << 8) | (uint32_t(uint8_t(code[2])) << 16) | (uint32_t(uint8_t(code[3])) << 24);
+    }
+
+    static compressed_format dds_fourcc(uint32_t f){
+        switch(f){
+            case fourcc("DXT1"): return {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 4, 4, 8, 4};
+            case fourcc("DXT3"): return {GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 4, 4, 16, 4};
+            case fourcc("DXT5"): return {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 4, 4, 16, 4};
+            case fourcc("ATI1"):
+            case fourcc("BC4U"): return {GL_COMPRESSED_RED_RGTC1, 4, 4, 8, 1};
+            case fourcc("BC4S"): return {GL_COMPRESSED_SIGNED_RED_RGTC1, 4, 4, 8, 1};
+            case fourcc("ATI2"):
+            case fourcc("BC5U"): return {GL_COMPRESSED_RG_RGTC2, 4, 4, 16, 2};
+            case fourcc("BC5S"): return {GL_COMPRESSED_SIGNED_RG_RGTC2, 4, 4, 16, 2};
+            default: return {};
+        }
+    }
+
+    static bool parse_ktx2(compressed_image& image){
+        static constexpr uint8_t identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+        const uint8_t* bytes = image.file.data();
+        const size_t size = image.file.size();
+        if(size < 80 || std::memcmp(bytes, identifier, sizeof(identifier)) != 0) return false;
+
+        const uint32_t depth = read<uint32_t>(bytes, 28), layers = read<uint32_t>(bytes, 32), faces = read<uint32_t>(bytes, 36);
+        const uint32_t supercompression = read<uint32_t>(bytes, 44);
+        gapi_asserts(depth <= 1 && layers <= 1 && faces == 1 && supercompression == 0, "Unsupported KTX2 layout");
+        if(depth > 1 || layers > 1 || faces != 1 || supercompression != 0) return false;
+
+        image.format = vk_format(read<uint32_t>(bytes, 12));
+        image.width = static_cast<int32_t>(read<uint32_t>(bytes, 20));
+        image.height = static_cast<int32_t>(std::max(1u, read<uint32_t>(bytes, 24)));
+        const uint32_t count = std::max(1u, read<uint32_t>(bytes, 40));
+        if(!image.format.valid() || size < 80 + size_t(count) * 24) return false;
+
+        for(uint32_t level = 0; level < count; level++){
+            const uint64_t offset = read<uint64_t>(bytes, 80 + level * 24);
+            const uint64_t length = read<uint64_t>(bytes, 80 + level * 24 + 8);
+            const int32_t w = std::max(1, image.width >> level), h = std::max(1, image.height >> level);
+            if(offset + length > size || length < image.format.level_size(w, h)) return false;
+            image.levels.push_back({bytes + offset, static_cast<size_t>(length), w, h});
+        }
+        return true;
+    }
+
+    static bool parse_dds(compressed_image& image){
+        const uint8_t* bytes = image.file.data();
+        const size_t size = image.file.size();
+        if(size < 128 || read<uint32_t>(bytes, 0) != fourcc("DDS ") || read<uint32_t>(bytes, 4) != 124) return false;
+
+        constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000, DDPF_FOURCC = 0x4, DDSCAPS2_CUBEMAP = 0x200, DDSCAPS2_VOLUME = 0x200000;
+        const uint32_t flags = read<uint32_t>(bytes, 8);
+        const uint32_t pixel_flags = read<uint32_t>(bytes, 80);
+        const uint32_t code = read<uint32_t>(bytes, 84);
+        const uint32_t caps2 = read<uint32_t>(bytes, 112);
+        if(!(pixel_flags & DDPF_FOURCC) || (caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME))) return false;
+
+        size_t offset = 128;
+        if(code == fourcc("DX10")){
+            if(size < 148 || read<uint32_t>(bytes, 140) > 1 || (read<uint32_t>(bytes, 136) & 0x4)) return false;
+            image.format = dxgi_format(read<uint32_t>(bytes, 128));
+            offset = 148;
+        }
+        else image.format = dds_fourcc(code);
+
+        image.height = static_cast<int32_t>(read<uint32_t>(bytes, 12));
+        image.width = static_cast<int32_t>(read<uint32_t>(bytes, 16));
+        const uint32_t count = (flags & DDSD_MIPMAPCOUNT) ? std::max(1u, read<uint32_t>(bytes, 28)) : 1;
+        if(!image.format.valid()) return false;
+
+        for(uint32_t level = 0; level < count; level++){
+            const int32_t w = std::max(1, image.width >> level), h = std::max(1, image.height >> level);
+            const size_t length = image.format.level_size(w, h);
+            if(offset + length > size) return false;
+            image.levels.push_back({bytes + offset, length, w, h});
+            offset += length;
+        }
+        return true;
+    }
+
+    size_t compressed_image::bytes() const {
+        size_t total = 0;
+        for(const auto& level : levels) total += level.size;
+        return total;
+    }
+
+    compressed_image load_compressed(const std::filesystem::path& path){
+        compressed_image image{};
+        image.file = gapi::mapped_file(path);
+        gapi_asserts(image.file.valid(), "Failed to map texture file");
+        if(!image.file.valid()) return image;
+
+        if(!parse_ktx2(image) && !parse_dds(image)){
+            gapi_asserts(false, "Unsupported compressed texture container");
+            image.format = {};
+            image.levels.clear();
+        }
+        return image;
+    }
+
+    bool is_compressed_container(const std::filesystem::path& path){
+        auto extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c){ return char(std::tolower(c)); });
+        return extension == ".ktx2" || extension == ".dds";
+    }
+
+    static uint64_t s_texture_clock{0};
+
+    static void upload_placeholder(){
+        const uint32_t placeholder = 0xFFFFFFFF;
+        GAPI_STAT(texture_bytes, sizeof(placeholder));
+        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+        gl(glTexImage2D(TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &placeholder));
+    }
+
+    // External layout the driver copies RGBA8 from without converting.
+    static GLenum preferred_layout(){
+        static const GLenum layout = []{
+            GLint format = GL_RGBA;
+            if(GLEW_ARB_internalformat_query2){
+                gl(glGetInternalformativ(GL_TEXTURE_2D, GL_RGBA8, GL_TEXTURE_IMAGE_FORMAT, 1, &format));
+            }
+            return format == GL_BGRA ? GLenum(GL_BGRA) : GLenum(GL_RGBA);
+        }();
+        return layout;
+    }
+
+    static void convert_pixels(const uint8_t* src, uint8_t* dst, size_t count, int32_t channels, GLenum layout){
+        if(channels == 3){
+            if(layout == GL_BGRA) gpack::rgb8_to_bgra8(src, dst, count);
+            else gpack::rgb8_to_rgba8(src, dst, count);
+        }
+        else if(layout == GL_BGRA) gpack::rgba8_to_bgra8(src, dst, count);
+        else std::memcpy(dst, src, count * 4);
+    }
+
+    // Magnification never samples a mip level; GL_TEXTURE_MAG_FILTER only accepts GL_NEAREST and GL_LINEAR.
+    static GLenum mag_filter(TEXTURE_FILTER filter){
+        return filter == TEX_FILTER_NEAREST || filter == TEX_FILTER_NEAREST_MIPMAP ? GL_NEAREST : GL_LINEAR;
+    }
+
+    texture_2d::texture_2d(std::filesystem::path path, TEXTURE_FILTER filter, TEXTURE_WRAP wrap,  bool flip){
+        create(filter, wrap);
+        image_data image = decode_image(path, flip);
+        if(mipmapped()) generate_mips(image);
+        upload(std::move(image));
+    }
+
+    texture_2d::texture_2d(TEXTURE_FILTER filter, TEXTURE_WRAP wrap){
+        create(filter, wrap);
+        upload_placeholder();
+    }
+
+    texture_2d::texture_2d(const compressed_image& image, TEXTURE_FILTER filter, TEXTURE_WRAP wrap){
+        create(filter, wrap);
+        upload_placeholder();
+        upload(image);
+    }
+
+    void texture_2d::create(TEXTURE_FILTER filter, TEXTURE_WRAP wrap){
+        m_filter = filter;
+        m_wrap = wrap;
+        GAPI_STAT(created, 1);
+        gl(glGenTextures(1, &m_id));
+        state_cache::current().bind_texture(0, TEXTURE_2D, m_id);
+        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter));
+        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter(filter)));
+        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap));
+        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap));
+    }
+
+    // Immutable storage cannot be respecified, so a new upload or an eviction needs a fresh texture object.
+    void texture_2d::recreate(){
+        GAPI_STAT(destroyed, 1);
+        state_cache::current().release_texture(m_id);
+        gl(glDeleteTextures(1, &m_id));
+        create(m_filter, m_wrap);
+        m_immutable = false;
+    }
+
+    void texture_2d::upload(image_data&& image){
+        gapi_asserts(image.valid() && (image.channels == 3 || image.channels == 4), "Texture format not supported");
+        if(!image.valid() || (image.channels != 3 && image.channels != 4)) return;
+
+        const GLenum layout = preferred_layout();
+        const GLenum type = layout == GL_BGRA ? GL_UNSIGNED_INT_8_8_8_8_REV : GL_UNSIGNED_BYTE;
+        const uint32_t levels = 1 + static_cast<uint32_t>(image.mips.size());
+
+        struct level{
+            const uint8_t* pixels;
+            int32_t width;
+            int32_t height;
+            size_t offset;
+        };
+
+        std::vector<level> chain;
+        chain.reserve(levels);
+        size_t total = 0;
+        chain.push_back({image.pixels.get(), image.width, image.height, total});
+        total += size_t(image.width) * image.height * 4;
+        for(const auto& mip : image.mips){
+            chain.push_back({mip.pixels.data(), mip.width, mip.height, total});
+            total += size_t(mip.width) * mip.height * 4;
+        }
+
+        if(m_immutable) recreate();
+        state_cache::current().bind_texture(0, TEXTURE_2D, m_id);
+        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1));
+
+        if(GLEW_ARB_texture_storage){
+            gl(glTexStorage2D(TEXTURE_2D, levels, GL_RGBA8, image.width, image.height));
+            m_immutable = true;
+        }
+        else{
+            for(uint32_t l = 0; l < levels; l++){
+                gl(glTexImage2D(TEXTURE_2D, l, GL_RGBA8, chain[l].width, chain[l].height, 0, layout, type, nullptr));
+            }
+        }
+
+        GAPI_STAT(texture_bytes, total);
+        uint32_t staging = 0;
+        gl(glGenBuffers(1, &staging));
+        gl(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging));
+        gl(glBufferData(GL_PIXEL_UNPACK_BUFFER, total, nullptr, GL_STREAM_DRAW));
+        void* mapped = gl(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+        std::vector<uint8_t> fallback;
+        uint8_t* dst = static_cast<uint8_t*>(mapped);
+        if(!dst){
+            gl(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+            fallback.resize(total);
+            dst = fallback.data();
+        }
+
+        for(const auto& l : chain) convert_pixels(l.pixels, dst + l.offset, size_t(l.width) * l.height, image.channels, layout);
+
+        if(mapped){
+            gl(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+        }
+
+        gl(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+        for(uint32_t l = 0; l < levels; l++){
+            const void* pixels = mapped ? reinterpret_cast<const void*>(static_cast<uintptr_t>(chain[l].offset)) : dst + chain[l].offset;
+            gl(glTexSubImage2D(TEXTURE_2D, l, 0, 0, chain[l].width, chain[l].height, layout, type, pixels));
+        }
+
+        gl(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+        gl(glDeleteBuffers(1, &staging));
+
+        m_width = image.width;
+        m_height = image.height;
+        m_channels = image.channels;
+        m_levels = levels;
+        m_bytes = total;
+        m_compressed = false;
+        m_readback.clear();
+        m_ready = true;
+        m_evicted = false;
+        m_requested = false;
+    }
+
+    // Capabilities of the context current on this thread, queried on first use.
+    static const info& context_info(){
+        thread_local const info instance;
+        return instance;
+    }
+
+    void texture_2d::upload(const compressed_image& image){
+        gapi_asserts(image.valid(), "Compressed image is not valid");
+        if(!image.valid()) return;
+
+        // Unsupported formats keep the placeholder for good; clearing m_evicted stops bind() from requesting a reload.
+        if(!context_info().supports_format(image.format.internal)){
+            gapi_debug_msg("Compressed texture format not supported by this context: ", image.format.internal);
+            m_ready = false;
+            m_evicted = false;
+            m_requested = false;
+            return;
+        }
+
+        const uint32_t levels = static_cast<uint32_t>(image.levels.size());
+        if(m_immutable) recreate();
+        state_cache::current().bind_texture(0, TEXTURE_2D, m_id);
+        gl(glTexParameteri(TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1));
+
+        if(GLEW_ARB_texture_storage){
+            gl(glTexStorage2D(TEXTURE_2D, levels, image.format.internal, image.width, image.height));
+            m_immutable = true;
+        }
+
+        for(uint32_t level = 0; level < levels; level++){
+            const auto& l = image.levels[level];
+            GAPI_STAT(texture_bytes, l.size);
+            if(m_immutable){
+                gl(glCompressedTexSubImage2D(TEXTURE_2D, level, 0, 0, l.width, l.height, image.format.internal, static_cast<GLsizei>(l.size), l.data));
+            }
+            else{
+                gl(glCompressedTexImage2D(TEXTURE_2D, level, image.format.internal, l.width, l.height, 0, static_cast<GLsizei>(l.size), l.data));
+            }
+        }
+
+        m_width = image.width;
+        m_height = image.height;
+        m_channels = image.format.channels;
+        m_levels = levels;
+        m_bytes = image.bytes();
+        m_compressed = true;
+        m_readback.clear();
+        m_ready = true;
+        m_evicted = false;
+        m_requested = false;
+    }
+
+    void texture_2d::evict(){
+        if(!m_ready) return;
+        if(m_immutable) recreate();
+        state_cache::current().bind_texture(0, TEXTURE_2D, m_id);
+        upload_placeholder();
+        m_readback.clear();
+        m_readback.shrink_to_fit();
+        m_ready = false;
+        m_evicted = true;
+        m_requested = false;
+    }
+
+    uint8_t* texture_2d::data() const {
+        if(!m_ready || m_compressed) return nullptr;
+        if(m_readback.empty()){
+            m_readback.resize(size_t(m_width) * m_height * m_channels);
+            state_cache::current().bind_texture(0, TEXTURE_2D, m_id);
+            gl(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+            gl(glGetTexImage(TEXTURE_2D, 0, m_channels == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, m_readback.data()));
+        }
+        return m_readback.data();
+    }
+
+    bool texture_2d::consume_request(){
+        if(!m_requested) return false;
+        m_requested = false;
+        m_evicted = false;
+        return true;
+    }
+
+    uint64_t texture_2d::clock(){
+        return s_texture_clock;
+    }
+
+    texture_2d::~texture_2d(){
+        GAPI_STAT(destroyed, 1);
+        state_cache::current().release_texture(m_id);
+        gl(glDeleteTextures(1, &m_id));
+    }
+
+    void texture_2d::bind(uint32_t slot) const {
+        m_last_bind = ++s_texture_clock;
+        if(m_evicted) m_requested = true;
+        state_cache::current().bind_texture(slot, m_type, m_id);
+    }
+
+    void texture_2d::unbind() const {
+    }
+
+    std::shared_ptr<texture_2d> texture_loader::load(std::filesystem::path path, TEXTURE_FILTER filter, TEXTURE_WRAP wrap, bool flip){
+        auto texture = std::make_shared<texture_2d>(filter, wrap);
+        reload(texture, std::move(path), flip);
+        return texture;
+    }
+
+    void texture_loader::reload(const std::shared_ptr<texture_2d>& texture, std::filesystem::path path, bool flip){
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+
+        m_pool.submit([this, path = std::move(path), flip, mips = texture->mipmapped(), weak = std::weak_ptr<texture_2d>(texture)]{
+            if(weak.expired()){
+                m_pending.fetch_sub(1, std::memory_order_relaxed);
+                return;
+            }
+
+            image_data image = decode_image(path, flip);
+            if(mips) generate_mips(image);
+            std::lock_guard lock(m_mutex);
+            m_decoded.push_back({weak, std::move(image)});
+        });
+    }
+
+    uint32_t texture_loader::update(size_t byte_budget, std::chrono::microseconds time_budget){
+        const auto start = std::chrono::steady_clock::now();
+        size_t bytes = 0;
+        uint32_t uploaded = 0;
+
+        for(;;){
+            decoded job;
+            {
+                std::lock_guard lock(m_mutex);
+                if(m_decoded.empty()) break;
+                if(uploaded && (bytes + m_decoded.front().image.bytes() > byte_budget || std::chrono::steady_clock::now() - start >= time_budget)) break;
+                job = std::move(m_decoded.front());
+                m_decoded.pop_front();
+            }
+
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            bytes += job.image.bytes();
+            uploaded++;
+
+            if(auto texture = job.texture.lock()) texture->upload(std::move(job.image));
+        }
+
+        return uploaded;
+    }
+
+    texture_2d_array::texture_2d_array(int32_t width, int32_t height, uint32_t layers, TEXTURE_FILTER filter, TEXTURE_WRAP wrap)
+        : m_width(width), m_height(height), m_layers(layers) {
+        const bool mipmapped = filter == TEX_FILTER_NEAREST_MIPMAP || filter == TEX_FILTER_LINEAR_MIPMAP;
+        m_levels = mipmapped ? gmip::level_count(width, height) : 1;
+
+        GAPI_STAT(created, 1);
+        gl(glGenTextures(1, &m_id));
+        state_cache::current().bind_texture(0, TEXTURE_2D_ARRAY, m_id);
+        gl(glTexParameteri(TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, filter));
+        gl(glTexParameteri(TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, mag_filter(filter)));
+        gl(glTexParameteri(TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap));
+        gl(glTexParameteri(TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap));
+        gl(glTexParameteri(TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, m_levels - 1));
+
+        if(GLEW_ARB_texture_storage){
+            gl(glTexStorage3D(TEXTURE_2D_ARRAY, m_levels, GL_RGBA8, width, height, layers));
+        }
+
+        for(uint32_t level = 0; level < m_levels; level++){
+            const int32_t w = std::max(1, width >> level), h = std::max(1, height >> level);
+            if(!GLEW_ARB_texture_storage){
+                gl(glTexImage3D(TEXTURE_2D_ARRAY, level, GL_RGBA8, w, h, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+            }
+            m_bytes += size_t(w) * h * 4 * layers;
+        }
+    }
+
+    texture_2d_array::~texture_2d_array(){
+        GAPI_STAT(destroyed, 1);
+        state_cache::current().release_texture(m_id);
+        gl(glDeleteTextures(1, &m_id));
+    }
+
+    void texture_2d_array::bind(uint32_t slot) const {
+        state_cache::current().bind_texture(slot, m_type, m_id);
+    }
+
+    void texture_2d_array::unbind() const {
+    }
+
+    void texture_2d_array::upload(uint32_t layer, const uint8_t* pixels){
+        gapi_asserts(layer < m_layers, "Texture array layer out of range");
+        if(layer >= m_layers) return;
+
+        state_cache::current().bind_texture(0, TEXTURE_2D_ARRAY, m_id);
+        gl(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        GAPI_STAT(texture_bytes, size_t(m_width) * m_height * 4);
+        gl(glTexSubImage3D(TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_width, m_height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+        if(m_levels == 1) return;
+
+        auto chain = gmip::build_chain(pixels, m_width, m_height, 4);
+        for(uint32_t level = 1; level < m_levels; level++){
+            const auto& mip = chain[level - 1];
+            GAPI_STAT(texture_bytes, mip.pixels.size());
+            gl(glTexSubImage3D(TEXTURE_2D_ARRAY, level, 0, 0, layer, mip.width, mip.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, mip.pixels.data()));
+        }
+    }
+
+    uint32_t texture_atlas::add(image_data&& image){
+        gapi_asserts(image.valid() && (image.channels == 3 || image.channels == 4), "Atlas images must be RGB or RGBA");
+        if(!image.valid() || (image.channels != 3 && image.channels != 4)) return INVALID;
+
+        if(image.channels == 3){
+            image_data rgba = allocate_image(image.width, image.height, 4);
+            gpack::rgb8_to_rgba8(image.pixels.get(), rgba.pixels.get(), size_t(image.width) * image.height);
+            image = std::move(rgba);
+        }
+
+        m_images.push_back(std::move(image));
+        m_regions.push_back({});
+        return static_cast<uint32_t>(m_regions.size() - 1);
+    }
+
+    static void blit_extruded(const image_data& src, image_data& dst, int32_t x, int32_t y, int32_t padding){
+        const uint8_t* in = src.pixels.get();
+        uint8_t* out = dst.pixels.get();
+        for(int32_t py = -padding; py < src.height + padding; py++){
+            const int32_t sy = std::clamp(py, 0, src.height - 1);
+            uint8_t* row = out + (size_t(y + padding + py) * dst.width + x + padding) * 4;
+            const uint8_t* src_row = in + size_t(sy) * src.width * 4;
+            std::memcpy(row, src_row, size_t(src.width) * 4);
+            for(int32_t p = 1; p <= padding; p++){
+                std::memcpy(row - p * 4, src_row, 4);
+                std::memcpy(row + (src.width - 1 + p) * 4, src_row + (src.width - 1) * 4, 4);
+            }
+        }
+    }
+
+    void texture_atlas::build(){
+        const uint32_t first = static_cast<uint32_t>(m_built);
+        const uint32_t count = static_cast<uint32_t>(m_images.size());
+        if(first == count) return;
+
+        std::unordered_map<uint64_t, std::vector<uint32_t>> sizes;
+        for(uint32_t id = first; id < count; id++){
+            if(m_images[id].valid()) sizes[(uint64_t(m_images[id].width) << 32) | uint32_t(m_images[id].height)].push_back(id);
+        }
+
+        std::vector<uint32_t> packed;
+        for(auto& [size, ids] : sizes){
+            if(ids.size() < m_min_layers){
+                packed.insert(packed.end(), ids.begin(), ids.end());
+                continue;
+            }
+
+            const auto& image = m_images[ids.front()];
+            auto array = std::make_shared<texture_2d_array>(image.width, image.height, static_cast<uint32_t>(ids.size()), m_filter, TEX_WRAP_REPEAT);
+            for(uint32_t layer = 0; layer < ids.size(); layer++){
+                array->upload(layer, m_images[ids[layer]].pixels.get());
+                m_regions[ids[layer]] = {array.get(), {0.0f, 0.0f, 1.0f, 1.0f}, layer, true};
+            }
+            m_arrays.push_back(std::move(array));
+        }
+
+        std::sort(packed.begin(), packed.end(), [this](uint32_t a, uint32_t b){
+            return m_images[a].height != m_images[b].height ? m_images[a].height > m_images[b].height : m_images[a].width > m_images[b].width;
+        });
+
+        struct page{
+            gapi::skyline_packer packer;
+            image_data image;
+            std::vector<uint32_t> ids;
+            std::vector<gapi::skyline_packer::rect> rects;
+        };
+        std::vector<page> pages;
+
+        for(uint32_t id : packed){
+            const int32_t w = m_images[id].width + 2 * m_padding, h = m_images[id].height + 2 * m_padding;
+            gapi::skyline_packer::rect r{};
+            page* target = nullptr;
+            for(auto& p : pages){
+                r = p.packer.pack(w, h);
+                if(r.valid()){
+                    target = &p;
+                    break;
+                }
+            }
+
+            if(!target){
+                pages.push_back({gapi::skyline_packer(std::max(m_page_size, w), std::max(m_page_size, h)), {}, {}, {}});
+                target = &pages.back();
+                r = target->packer.pack(w, h);
+            }
+
+            target->ids.push_back(id);
+            target->rects.push_back(r);
+        }
+
+        for(auto& p : pages){
+            const int32_t width = p.packer.width(), height = p.packer.height();
+            p.image = allocate_image(width, height, 4);
+
+            auto texture = std::make_shared<texture_2d>(m_filter, TEX_WRAP_CLAMP);
+            for(size_t i = 0; i < p.ids.size(); i++){
+                const auto& image = m_images[p.ids[i]];
+                const auto& r = p.rects[i];
+                blit_extruded(image, p.image, r.x, r.y, m_padding);
+
+                const float u0 = float(r.x + m_padding) / width, v0 = float(r.y + m_padding) / height;
+                const float u1 = float(r.x + m_padding + image.width) / width, v1 = float(r.y + m_padding + image.height) / height;
+                m_regions[p.ids[i]] = {texture.get(), {u0, v0, u1, v1}, 0, false};
+            }
+
+            if(texture->mipmapped()) generate_mips(p.image);
+            texture->upload(std::move(p.image));
+            m_pages.push_back(std::move(texture));
+        }
+
+        for(uint32_t id = first; id < count; id++) m_images[id] = {};
+        m_built = count;
+    }
+
+    std::shared_ptr<texture_2d> texture_cache::get(const std::filesystem::path& path, TEXTURE_FILTER filter, TEXTURE_WRAP wrap, bool flip){
+        key k{path.string(), filter, wrap, flip};
+        if(auto it = m_entries.find(k); it != m_entries.end()) return it->second;
+
+        std::shared_ptr<texture_2d> texture;
+        if(is_compressed_container(path)) texture = std::make_shared<texture_2d>(load_compressed(path), filter, wrap);
+        else if(m_loader) texture = m_loader->load(path, filter, wrap, flip);
+        else texture = std::make_shared<texture_2d>(path, filter, wrap, flip);
+        m_bytes += texture->bytes();
+        m_entries.emplace(std::move(k), texture);
+        return texture;
+    }
+
+    void texture_cache::update(){
+        const uint64_t previous = m_frame;
+        m_frame = texture_2d::clock();
+        m_bytes = 0;
+
+        for(auto& [k, texture] : m_entries){
+            if(texture->consume_request()){
+                if(is_compressed_container(k.path)) texture->upload(load_compressed(k.path));
+                else if(m_loader) m_loader->reload(texture, k.path, k.flip);
+                else{
+                    image_data image = decode_image(k.path, k.flip);
+                    if(texture->mipmapped()) generate_mips(image);
+                    texture->upload(std::move(image));
+                }
+            }
+            m_bytes += texture->bytes();
+        }
+
+        if(m_bytes <= m_budget) return;
+
+        using entry = decltype(m_entries)::iterator;
+        std::vector<entry> candidates;
+        candidates.reserve(m_entries.size());
+        for(auto it = m_entries.begin(); it != m_entries.end(); ++it) candidates.push_back(it);
+
+        std::sort(candidates.begin(), candidates.end(), [](const entry& a, const entry& b){
+            const bool unused_a = a->second.use_count() == 1, unused_b = b->second.use_count() == 1;
+            if(unused_a != unused_b) return unused_a;
+            return a->second->last_bind() < b->second->last_bind();
+        });
+
+        for(auto& it : candidates){
+            if(m_bytes <= m_budget) break;
+
+            auto& texture = it->second;
+            const size_t before = texture->bytes();
+            if(texture.use_count() == 1){
+                m_bytes -= before;
+                m_entries.erase(it);
+            }
+            else if(texture->ready() && texture->last_bind() <= previous){
+                texture->evict();
+                m_bytes -= before - texture->bytes();
+            }
+        }
+    }
+
+    void texture_cache::clear(){
+        m_entries.clear();
+        m_bytes = 0;
+    }
+
+    api::~api() {
+        if(m_indirect){
+            gl(glDeleteBuffers(1, &m_indirect));
+        }
+    }
+
+    void api::init() {
+        frame_stats::make_current(&m_stats);
+        gl(glGenBuffers(1, &m_indirect));
+        gl(glEnable(GL_BLEND));
+        gl(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    }
+    static GLenum gl_index_type(gapi::INDEX type){
+        switch(type){
+            case gapi::INDEX::U8:   return UBYTE;
+            case gapi::INDEX::U16:  return USHORT;
+            default:                return UINT;
+        }
+    }
+
+    void api::draw(const gapi::vertex_array& va) {
+        draw(va, {});
+    }
+
+    void api::draw(const gapi::vertex_array& va, const gapi::draw_range& range) {
+        auto& index_buffer = va.index();
+        uint32_t count = range.count ? range.count : (index_buffer ? index_buffer->count() : 0);
+        if(count == 0 || range.instances == 0) return;
+
+        const gapi::INDEX index_type = va.index_type();
+        const GLenum type = gl_index_type(index_type);
+        const void* offset = reinterpret_cast<const void*>(static_cast<uintptr_t>(range.first) * static_cast<uint32_t>(index_type));
+        GAPI_STAT(draws, 1);
+        GAPI_STAT(instances, range.instances);
+        GAPI_STAT(triangles, static_cast<uint64_t>(count / 3) * range.instances);
+        if(range.base_instance){
+            gl(glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, count, type, offset, range.instances, range.base_vertex, range.base_instance));
+        }
+        else if(range.instances > 1){
+            gl(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, type, offset, range.instances, range.base_vertex));
+        }
+        else if(range.base_vertex){
+            gl(glDrawElementsBaseVertex(GL_TRIANGLES, count, type, offset, range.base_vertex));
+        }
+        else{
+            gl(glDrawElements(GL_TRIANGLES, count, type, offset));
+        }
+    }
+
+    void api::draw_multi(const gapi::vertex_array& va, std::span<const gapi::draw_range> ranges) {
+        if(ranges.empty()) return;
+        if(!GLEW_ARB_multi_draw_indirect || ranges.size() == 1){
+            for(const auto& range : ranges) draw(va, range);
+            return;
+        }
+
+        auto& index_buffer = va.index();
+        const uint32_t whole = index_buffer ? index_buffer->count() : 0;
+        m_commands.clear();
+        for(const auto& range : ranges){
+            if(range.instances == 0) continue;
+            m_commands.push_back({range.count ? range.count : whole, range.instances, range.first, range.base_vertex, range.base_instance});
+            GAPI_STAT(instances, range.instances);
+            GAPI_STAT(triangles, static_cast<uint64_t>(m_commands.back().count / 3) * range.instances);
+        }
+        if(m_commands.empty()) return;
+
+        GAPI_STAT(draws, 1);
+        GAPI_STAT(buffer_bytes, m_commands.size() * sizeof(draw_indirect));
+        gl(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirect));
+        gl(glBufferData(GL_DRAW_INDIRECT_BUFFER, m_commands.size() * sizeof(draw_indirect), m_commands.data(), GL_STREAM_DRAW));
+        gl(glMultiDrawElementsIndirect(GL_TRIANGLES, gl_index_type(va.index_type()), nullptr, static_cast<GLsizei>(m_commands.size()), 0));
+    }
+
+    void api::end_frame() {
+        m_stats.end_frame();
+    }
+
+    void api::clear() {
+        gl(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    }
+
+    void api::clear_color(float r, float g, float b, float a) {
+        gl(glClearColor(r, g, b, a));
+    }
+
+    void api::bind_range(const gapi::buffer_range& range) {
+        gl(glBindBufferRange(GL_UNIFORM_BUFFER, range.binding, range.buffer, range.offset, range.size));
     }
 
     std::shared_ptr<context> make_context(GLFWwindow* window) noexcept{
         return std::make_shared<context>(window);
     }
 
-    std::shared_ptr<vertex_buffer> make_vertex(float* v, uint32_t s, DRAW t) noexcept{
+    std::shared_ptr<upload_context> make_upload_context(GLFWwindow* shared) noexcept{
+        return std::make_shared<upload_context>(shared);
+    }
+
+    std::shared_ptr<profiler> make_profiler() noexcept{
+        return std::make_shared<profiler>();
+    }
+
+    std::shared_ptr<vertex_buffer> make_vertex(const void* v, uint32_t s, DRAW t) noexcept{
         return std::make_shared<gapi::opengl::vertex_buffer>(v, s, t);
     }
 
-    std::shared_ptr<index_buffer> make_index(uint32_t* i, size_t c, DRAW t) noexcept{
-        return std::make_shared<index_buffer>(i, c, t);
+    std::shared_ptr<index_buffer> make_index(const void* i, uint32_t count, gapi::INDEX type, DRAW t) noexcept{
+        return std::make_shared<index_buffer>(i, count, type, t);
+    }
+
+    std::shared_ptr<index_buffer> make_index(const uint32_t* i, uint32_t count, uint32_t vertex_count, DRAW t) noexcept{
+        gapi::index_data data = gapi::narrow_indices(i, count, vertex_count);
+        return std::make_shared<index_buffer>(data.bytes.data(), data.count, data.type, t);
     }
 
     std::shared_ptr<vertex_array> make_array() noexcept{
@@ -493,12 +2542,44 @@ namespace gapi::opengl{
         return std::make_shared<texture_2d>(path, filter, wrap, flip);
     }
 
-    std::shared_ptr<shader> make_shader(const std::string& sname, const std::filesystem::path& path) noexcept{
-        return std::make_shared<shader>(sname, path);
+    std::shared_ptr<texture_2d> make_texture2d(const compressed_image& image, TEXTURE_FILTER filter, TEXTURE_WRAP wrap) noexcept{
+        return std::make_shared<texture_2d>(image, filter, wrap);
+    }
+
+    std::shared_ptr<texture_2d_array> make_texture2d_array(int32_t width, int32_t height, uint32_t layers, TEXTURE_FILTER filter, TEXTURE_WRAP wrap) noexcept{
+        return std::make_shared<texture_2d_array>(width, height, layers, filter, wrap);
+    }
+
+    std::shared_ptr<texture_atlas> make_texture_atlas(TEXTURE_FILTER filter, int32_t page_size, int32_t padding, uint32_t min_layers) noexcept{
+        return std::make_shared<texture_atlas>(filter, page_size, padding, min_layers);
+    }
+
+    std::shared_ptr<texture_loader> make_texture_loader(uint32_t threads) noexcept{
+        return std::make_shared<texture_loader>(threads);
+    }
+
+    std::shared_ptr<texture_cache> make_texture_cache(size_t budget, std::shared_ptr<texture_loader> loader) noexcept{
+        return std::make_shared<texture_cache>(budget, std::move(loader));
+    }
+
+    std::shared_ptr<program_cache> make_program_cache(std::filesystem::path directory, const info& gl_info) noexcept{
+        return std::make_shared<program_cache>(std::move(directory), gl_info);
+    }
+
+    std::shared_ptr<shader> make_shader(const std::string& sname, const std::filesystem::path& path, SHADER_BUILD mode) noexcept{
+        return std::make_shared<shader>(sname, path, mode);
+    }
+
+    std::shared_ptr<shader> make_shader(const std::string& sname, const std::filesystem::path& vertex, const std::filesystem::path& fragment, SHADER_BUILD mode) noexcept{
+        return std::make_shared<shader>(sname, vertex, fragment, mode);
+    }
+
+    std::shared_ptr<shader_preprocessor> make_shader_preprocessor(const info& gl_info, std::vector<std::filesystem::path> include_paths) noexcept{
+        return std::make_shared<shader_preprocessor>(gl_info, std::move(include_paths));
     }
 
-    std::shared_ptr<shader> make_shader(const std::string& sname, const std::filesystem::path& vertex, const std::filesystem::path& fragment) noexcept{
-        return std::make_shared<shader>(sname, vertex, fragment);
+    std::shared_ptr<shader_variants> make_shader_variants(std::string sname, std::filesystem::path path, std::shared_ptr<shader_preprocessor> preprocessor, SHADER_BUILD mode) noexcept{
+        return std::make_shared<shader_variants>(std::move(sname), std::move(path), std::move(preprocessor), mode);
     }
 
 }
\ No newline at end of file
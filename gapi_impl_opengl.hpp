@@ -11,6 +11,29 @@
 
 #include <stb_image.h>
 #include "gapi.hpp"
+#include "gapi_thread_pool.hpp"
+#include "gapi_mapped_file.hpp"
+#include "gapi_mipmap.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <optional>
+#include <unordered_set>
+
+#ifdef GAPI_PROFILE
+#define GAPI_PROFILE_CONCAT_INNER(a, b) a##b
+#define GAPI_PROFILE_CONCAT(a, b) GAPI_PROFILE_CONCAT_INNER(a, b)
+#define GAPI_PROFILE_ZONE(name) gapi::opengl::profile_zone GAPI_PROFILE_CONCAT(gapi_zone_, __LINE__){name}
+#else
+#define GAPI_PROFILE_ZONE(name)
+#endif
+
+#ifdef GAPI_STATS
+#define GAPI_STAT(counter, n) (gapi::opengl::frame_stats::current().counter += (n))
+#else
+#define GAPI_STAT(counter, n) ((void)0)
+#endif
 
 namespace gapi::opengl{
 
@@ -30,7 +53,10 @@ namespace gapi::opengl{
         INT             = GL_INT,
         UINT            = GL_UNSIGNED_INT,
         FLOAT           = GL_FLOAT,
-        DOUBLE          = GL_DOUBLE
+        DOUBLE          = GL_DOUBLE,
+        HALF            = GL_HALF_FLOAT,
+        INT_2_10_10_10  = GL_INT_2_10_10_10_REV,
+        UINT_2_10_10_10 = GL_UNSIGNED_INT_2_10_10_10_REV
     };
 
     enum DRAW_MODE : GLenum {
@@ -53,6 +79,12 @@ namespace gapi::opengl{
         SHADER_GEOMETRY        = GL_GEOMETRY_SHADER
     };
 
+    // Scoped so that string literals cannot convert to it and pick the single-file shader constructor.
+    enum class SHADER_BUILD : uint32_t {
+        IMMEDIATE = 0,
+        DEFERRED  = 1
+    };
+
     enum TEXTURE_TYPE : GLenum {
 
         TEXTURE_NONE            = GL_NONE,
@@ -88,12 +120,212 @@ namespace gapi::opengl{
             inline virtual const std::string& renderer() const override { return m_renderer;        }
             inline virtual const std::string& version() const override  { return m_version;         }
             inline virtual const std::string& language() const override { return m_glsl_version;    }
+            inline int32_t major() const { return m_major; }
+            inline int32_t minor() const { return m_minor; }
+            inline const std::vector<std::string>& extensions() const { return m_extensions; }
+
+            [[nodiscard]] bool supports(std::string_view extension) const;
+            [[nodiscard]] bool supports_format(uint32_t internal_format) const;
         
         private:
             std::string m_vendor;
             std::string m_renderer;
             std::string m_version;
             std::string m_glsl_version;
+            int32_t m_major{0};
+            int32_t m_minor{0};
+            std::vector<std::string> m_extensions{};
+    };
+
+    class state_cache final {
+
+        public:
+            static constexpr uint32_t MAX_TEXTURE_UNITS = 32;
+            static constexpr uint32_t UNKNOWN = 0xFFFFFFFF;
+
+            struct counters{
+                uint64_t issued{0};
+                uint64_t skipped{0};
+            };
+
+            state_cache() { invalidate(); }
+            state_cache(const state_cache&) = delete;
+            state_cache& operator=(const state_cache&) = delete;
+            ~state_cache() = default;
+
+            [[nodiscard]] static state_cache& current();
+            static void make_current(state_cache* cache);
+
+            void bind_program(uint32_t id);
+            void bind_vertex_array(uint32_t id);
+            void bind_buffer(GLenum target, uint32_t id);
+            void bind_texture(uint32_t unit, TEXTURE_TYPE target, uint32_t id);
+
+            void release_program(uint32_t id);
+            void release_vertex_array(uint32_t id);
+            void release_buffer(uint32_t id);
+            void release_texture(uint32_t id);
+            void invalidate();
+
+            [[nodiscard]] inline const counters& stats() const { return m_counters; }
+            inline void reset_stats() { m_counters = {}; }
+
+        private:
+            bool redundant(uint32_t& shadow, uint32_t id);
+            void active_unit(uint32_t unit);
+
+        private:
+            uint32_t m_program{UNKNOWN};
+            uint32_t m_vertex_array{UNKNOWN};
+            uint32_t m_array_buffer{UNKNOWN};
+            uint32_t m_element_buffer{UNKNOWN};
+            uint32_t m_active_unit{UNKNOWN};
+            std::array<std::array<uint32_t, 4>, MAX_TEXTURE_UNITS> m_textures{};
+            counters m_counters{};
+    };
+
+    // Times in microseconds on the profiler's CPU clock; GPU times are mapped onto it.
+    struct profile_event{
+        const char* name{nullptr};
+        uint32_t depth{0};
+        uint64_t frame{0};
+        double cpu_begin{0.0};
+        double cpu_end{0.0};
+        double gpu_begin{0.0};
+        double gpu_end{0.0};
+        bool gpu{false};
+    };
+
+    // Zones record CPU time and, with timer queries, a GL_TIMESTAMP pair on the GPU; timestamps nest where
+    // TIME_ELAPSED queries cannot. A frame's queries are read back LATENCY frames later when its slot is
+    // reused, and results that are still not available are dropped rather than waited for.
+    class profiler final {
+
+        public:
+            static constexpr uint32_t LATENCY = 3;
+
+            profiler();
+            profiler(const profiler&) = delete;
+            profiler& operator=(const profiler&) = delete;
+            ~profiler();
+
+            [[nodiscard]] static profiler* current();
+            static void make_current(profiler* instance);
+
+            // name must outlive the profiler; zones normally use string literals.
+            [[nodiscard]] uint32_t begin(const char* name);
+            void end(uint64_t frame, uint32_t zone);
+            void end_frame();
+
+            // Resolved zones accumulate while capturing, for write_trace.
+            inline void capture(bool enabled) { m_capture = enabled; }
+            inline void clear() { m_trace.clear(); }
+            // Chrome trace / Perfetto JSON with CPU and GPU zones on separate tracks.
+            bool write_trace(const std::filesystem::path& path) const;
+
+            [[nodiscard]] inline uint64_t frame() const { return m_frame; }
+            [[nodiscard]] inline bool gpu() const { return m_gpu; }
+            [[nodiscard]] inline const std::vector<profile_event>& last_frame() const { return m_resolved; }
+            [[nodiscard]] inline const std::vector<profile_event>& trace() const { return m_trace; }
+
+        private:
+            struct slot{
+                uint64_t frame{0};
+                double offset{0.0};
+                std::vector<profile_event> zones{};
+                std::vector<uint32_t> queries{};
+            };
+
+            double now() const;
+            void resolve(slot& s);
+
+        private:
+            std::chrono::steady_clock::time_point m_epoch{};
+            std::array<slot, LATENCY + 1> m_slots{};
+            std::vector<profile_event> m_resolved{};
+            std::vector<profile_event> m_trace{};
+            uint64_t m_frame{0};
+            uint32_t m_depth{0};
+            bool m_gpu{false};
+            bool m_capture{false};
+    };
+
+    // Does nothing when the thread has no current profiler.
+    class profile_zone final {
+
+        public:
+            explicit profile_zone(const char* name): m_profiler(profiler::current()){
+                if(m_profiler){
+                    m_frame = m_profiler->frame();
+                    m_index = m_profiler->begin(name);
+                }
+            }
+
+            profile_zone(const profile_zone&) = delete;
+            profile_zone& operator=(const profile_zone&) = delete;
+
+            ~profile_zone(){
+                if(m_profiler) m_profiler->end(m_frame, m_index);
+            }
+
+        private:
+            profiler* m_profiler{nullptr};
+            uint64_t m_frame{0};
+            uint32_t m_index{0};
+    };
+
+    // Work issued to GL in one frame. Binds count only calls that got past the state cache,
+    // and uniform sets only values that changed.
+    struct frame_counters{
+        uint64_t draws{0};
+        uint64_t instances{0};
+        uint64_t triangles{0};
+        uint64_t program_binds{0};
+        uint64_t vertex_array_binds{0};
+        uint64_t texture_binds{0};
+        uint64_t uniform_sets{0};
+        uint64_t buffer_bytes{0};
+        uint64_t texture_bytes{0};
+        uint64_t created{0};
+        uint64_t destroyed{0};
+    };
+
+    // Counters are only collected when built with GAPI_STATS; otherwise GAPI_STAT compiles to nothing.
+    class frame_stats final {
+
+        public:
+            static constexpr uint32_t WINDOW = 240;
+
+            struct summary{
+                double min{0.0};
+                double avg{0.0};
+                double max{0.0};
+                double p99{0.0};
+            };
+
+            frame_stats() = default;
+            frame_stats(const frame_stats&) = delete;
+            frame_stats& operator=(const frame_stats&) = delete;
+            ~frame_stats();
+
+            // The current frame of the thread's stats, or a scratch set when none is current.
+            [[nodiscard]] static frame_counters& current();
+            static void make_current(frame_stats* stats);
+
+            void end_frame();
+            void reset();
+
+            // Over the last WINDOW completed frames, e.g. stats.rolling(&frame_counters::draws).
+            [[nodiscard]] summary rolling(uint64_t frame_counters::* counter) const;
+            [[nodiscard]] inline const frame_counters& frame() const { return m_frame; }
+            [[nodiscard]] inline const frame_counters& last() const { return m_history[(m_head + WINDOW - 1) % WINDOW]; }
+            [[nodiscard]] inline uint32_t frames() const { return m_count; }
+
+        private:
+            frame_counters m_frame{};
+            std::array<frame_counters, WINDOW> m_history{};
+            uint32_t m_head{0};
+            uint32_t m_count{0};
     };
 
     class context final : public gapi::context{
@@ -101,22 +333,97 @@ namespace gapi::opengl{
         public:
             context() {}
             context(GLFWwindow* window): m_window(window) { }
-            virtual ~context() = default;
+            virtual ~context();
 
             virtual bool init() override;
             virtual void swap() override;
             virtual void interval(uint32_t interval) override;
             inline const std::shared_ptr<gapi::opengl::info>& info() const { return m_info; }
+            inline state_cache& state() { return m_state; }
 
         private:
             GLFWwindow* m_window{nullptr};
             std::shared_ptr<gapi::opengl::info> m_info{nullptr};
+            state_cache m_state{};
+    };
+
+    // Hidden context sharing objects with the main one. Buffers, textures, programs and syncs are shared;
+    // vertex arrays are not, so build those in the publish callback which runs on the render thread.
+    class upload_context final {
+
+        public:
+            upload_context(GLFWwindow* shared): m_shared(shared) {}
+            upload_context(const upload_context&) = delete;
+            upload_context& operator=(const upload_context&) = delete;
+            ~upload_context();
+
+            bool init();
+
+            void submit(std::function<void()> work, std::function<void()> publish = {});
+
+            // Hands the value created on the upload thread to publish on the render thread. Void work uses the overload above.
+            template<typename Create, typename Publish>
+                requires (!std::is_void_v<std::invoke_result_t<Create&>> && std::is_invocable_v<Publish&, std::invoke_result_t<Create&>>)
+            void submit(Create&& create, Publish&& publish){
+                auto result = std::make_shared<std::optional<std::invoke_result_t<Create&>>>();
+                submit([result, create = std::forward<Create>(create)]() mutable { result->emplace(create()); },
+                       [result, publish = std::forward<Publish>(publish)]() mutable { publish(std::move(**result)); });
+            }
+
+            // Render thread: runs publish callbacks, in submission order, for jobs whose fence has signaled.
+            uint32_t poll();
+
+            [[nodiscard]] inline uint32_t pending() const { return m_pending.load(std::memory_order_relaxed); }
+            inline state_cache& state() { return m_state; }
+
+        private:
+            struct job{
+                std::function<void()> work{};
+                std::function<void()> publish{};
+            };
+
+            struct finished{
+                GLsync fence{nullptr};
+                std::function<void()> publish{};
+            };
+
+            void run();
+
+        private:
+            GLFWwindow* m_shared{nullptr};
+            GLFWwindow* m_window{nullptr};
+            state_cache m_state{};
+            std::mutex m_mutex{};
+            std::condition_variable m_signal{};
+            std::deque<job> m_jobs{};
+            std::deque<finished> m_finished{};
+            std::atomic<uint32_t> m_pending{0};
+            bool m_stop{false};
+            std::thread m_thread{};
+    };
+
+    class buffer_mirror final {
+
+        public:
+            static constexpr size_t MERGE_GAP = 256;
+
+            buffer_mirror() = default;
+            ~buffer_mirror() = default;
+
+            void assign(const void* data, size_t size);
+            void write(uint32_t id, size_t capacity, size_t offset, std::span<const std::byte> data);
+            void flush(uint32_t id, size_t capacity, DRAW usage);
+            [[nodiscard]] inline bool dirty() const { return !m_dirty.empty(); }
+
+        private:
+            std::vector<uint8_t> m_data{};
+            gapi::dirty_ranges m_dirty{MERGE_GAP};
     };
 
     class vertex_buffer final : public gapi::vertex_buffer {
 
         public:
-            vertex_buffer(float* v, uint32_t s, DRAW t);
+            vertex_buffer(const void* v, uint32_t s, DRAW t);
             virtual ~vertex_buffer();
 
             virtual void bind() const override;
@@ -124,24 +431,85 @@ namespace gapi::opengl{
             virtual void configure_layout(const gapi::buffer_layout& layout) override { m_layout = layout; };
             virtual const gapi::buffer_layout& layout() const override { return m_layout; };
 
+            using gapi::vertex_buffer::update;
+            virtual void update(size_t offset, std::span<const std::byte> data) override;
+            virtual void flush() override;
+            inline uint32_t id() const { return m_id; }
+
         private:
             uint32_t m_id{0};
+            uint32_t m_size{0};
+            DRAW m_usage{DRAW_STATIC};
+            buffer_mirror m_mirror{};
             gapi::buffer_layout m_layout{};
     };
 
     class index_buffer final : public gapi::index_buffer {
 
         public:
-            index_buffer(uint32_t* i, size_t c, DRAW t);
+            index_buffer(const void* i, uint32_t count, gapi::INDEX type, DRAW t);
             virtual ~index_buffer();
 
             void bind() const override;
             void unbind() const override;
-            inline size_t count() const override { return m_count; }
+            inline uint32_t count() const override { return m_count; }
+            inline gapi::INDEX type() const override { return m_type; }
+
+            using gapi::index_buffer::update;
+            virtual void update(size_t offset, std::span<const std::byte> data) override;
+            virtual void flush() override;
+            inline uint32_t id() const { return m_id; }
 
         private:
             uint32_t m_id{0};
-            size_t m_count{0};
+            uint32_t m_count{0};
+            gapi::INDEX m_type{gapi::INDEX::U32};
+            size_t m_size{0};
+            DRAW m_usage{DRAW_STATIC};
+            buffer_mirror m_mirror{};
+    };
+
+    // Ring of per-frame regions for geometry written by the CPU every frame. Each frame runs in this order:
+    //   begin_frame()  waits for the region's fence and, without ARB_buffer_storage, maps it
+    //   allocate()     any number of times; write through allocation::data
+    //   unmap()        after the last write; the fallback path cannot draw from a mapped buffer
+    //   draws          that source from the region
+    //   end_frame()    after those draws, fences the region and advances the ring
+    class stream_buffer final {
+
+        public:
+            struct allocation{
+                uint8_t* data{nullptr};
+                uint32_t offset{0};
+                uint32_t size{0};
+            };
+
+            stream_buffer(uint32_t frame_size, uint32_t frames = 3);
+            stream_buffer(const stream_buffer&) = delete;
+            stream_buffer& operator=(const stream_buffer&) = delete;
+            ~stream_buffer();
+
+            [[nodiscard]] allocation allocate(uint32_t size, uint32_t alignment = 4);
+            void begin_frame();
+            void unmap();
+            void end_frame();
+
+            inline uint32_t id() const { return m_id; }
+            inline bool persistent() const { return m_persistent; }
+
+        private:
+            void wait(uint32_t frame);
+
+        private:
+            uint32_t m_id{0};
+            uint32_t m_frame_size{0};
+            uint32_t m_frames{0};
+            uint32_t m_frame{0};
+            uint32_t m_head{0};
+            uint8_t* m_mapped{nullptr};
+            uint32_t m_mapped_offset{0};
+            bool m_persistent{false};
+            std::vector<GLsync> m_fences{};
     };
 
     class vertex_array final : public gapi::vertex_array {
@@ -152,33 +520,178 @@ namespace gapi::opengl{
 
             void bind() const override;
             void unbind() const override;
+            inline uint32_t id() const override { return m_id; }
             void emplace_vertex(const std::shared_ptr<gapi::vertex_buffer>& vb) override;
             void emplace_index(const std::shared_ptr<gapi::index_buffer>& ib) override;
+            void emplace_stream(const std::shared_ptr<stream_buffer>& stream, const gapi::buffer_layout& layout, gapi::INDEX type = gapi::INDEX::U32);
             inline const std::vector<std::shared_ptr<gapi::vertex_buffer>>& vertexs() const override { return m_vertex_buffers; }
             inline const std::shared_ptr<gapi::index_buffer>& index() const override { return m_index_buffer; }
+            inline gapi::INDEX index_type() const override { return m_index_buffer ? m_index_buffer->type() : m_stream_index; }
+
+        private:
+            void attributes(const gapi::buffer_layout& layout);
 
         private:
             uint32_t m_id{0};
+            uint32_t m_attributes{0};
             std::vector<std::shared_ptr<gapi::vertex_buffer>> m_vertex_buffers{};
             std::shared_ptr<gapi::index_buffer> m_index_buffer{};
+            std::shared_ptr<stream_buffer> m_stream{};
+            gapi::INDEX m_stream_index{gapi::INDEX::U32};
+    };
+
+    class uniform_ring final {
+
+        public:
+            struct allocation{
+                uint8_t* data{nullptr};
+                gapi::buffer_range range{};
+            };
+
+            uniform_ring(uint32_t frame_size, uint32_t frames = 3);
+            uniform_ring(const uniform_ring&) = delete;
+            uniform_ring& operator=(const uniform_ring&) = delete;
+            ~uniform_ring();
+
+            [[nodiscard]] allocation allocate(uint32_t size, uint32_t binding = 0);
+
+            template<gapi::BLOCK_LAYOUT Layout, size_t N>
+            [[nodiscard]] allocation allocate(const gapi::block_layout<Layout, N>& layout, uint32_t binding = 0) {
+                return allocate(layout.size(), binding);
+            }
+
+            void upload();
+            void next_frame();
+
+            inline uint32_t id() const { return m_id; }
+            inline uint32_t used() const { return m_head; }
+
+        private:
+            uint32_t m_id{0};
+            uint32_t m_frame_size{0};
+            uint32_t m_frames{0};
+            uint32_t m_frame{0};
+            uint32_t m_head{0};
+            uint32_t m_uploaded{0};
+            uint32_t m_alignment{256};
+            std::vector<uint8_t> m_staging{};
+    };
+
+    class geometry_pool final {
+
+        public:
+            struct mesh{
+                uint32_t base_vertex{gapi::range_allocator::INVALID};
+                uint32_t vertex_count{0};
+                uint32_t first_index{gapi::range_allocator::INVALID};
+                uint32_t index_count{0};
+
+                [[nodiscard]] inline bool valid() const { return base_vertex != gapi::range_allocator::INVALID && first_index != gapi::range_allocator::INVALID; }
+                [[nodiscard]] inline gapi::draw_range range() const { return {index_count, first_index, static_cast<int32_t>(base_vertex)}; }
+            };
+
+            geometry_pool(const gapi::buffer_layout& layout, uint32_t vertex_capacity, uint32_t index_capacity, gapi::INDEX type = gapi::INDEX::U32);
+            geometry_pool(const geometry_pool&) = delete;
+            geometry_pool& operator=(const geometry_pool&) = delete;
+            ~geometry_pool() = default;
+
+            [[nodiscard]] mesh allocate(const void* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count);
+            void release(const mesh& m);
+
+            inline const std::shared_ptr<vertex_array>& array() const { return m_array; }
+            inline const gapi::buffer_layout& layout() const { return m_layout; }
+
+        private:
+            gapi::buffer_layout m_layout{};
+            std::shared_ptr<vertex_buffer> m_vertices{};
+            std::shared_ptr<index_buffer> m_indices{};
+            std::shared_ptr<vertex_array> m_array{};
+            gapi::range_allocator m_vertex_ranges{};
+            gapi::range_allocator m_index_ranges{};
+            std::vector<uint8_t> m_staging{};
+    };
+
+    // Linked program binaries on disk, keyed by the preprocessed sources and the driver that produced them.
+    // Shaders compiled on a thread with a current cache load from it first and store into it after linking.
+    class program_cache final {
+
+        public:
+            struct counters{
+                uint32_t hits{0};
+                uint32_t misses{0};
+                uint32_t rejected{0};
+                double load_ms{0.0};
+                double compile_ms{0.0};
+            };
+
+            program_cache(std::filesystem::path directory, const info& gl_info);
+            program_cache(const program_cache&) = delete;
+            program_cache& operator=(const program_cache&) = delete;
+            ~program_cache() = default;
+
+            [[nodiscard]] static program_cache* current();
+            static void make_current(program_cache* cache);
+
+            [[nodiscard]] uint64_t key(const std::unordered_map<SHADER_TYPE, std::string>& sources) const;
+            // A linked program, or 0 when the entry is missing or the driver rejects it.
+            [[nodiscard]] uint32_t load(uint64_t key);
+            void store(uint64_t key, uint32_t program, double compile_ms);
+            void clear();
+
+            [[nodiscard]] inline bool enabled() const { return m_enabled; }
+            [[nodiscard]] inline const counters& stats() const { return m_counters; }
+            inline void reset_stats() { m_counters = {}; }
+
+        private:
+            std::filesystem::path entry(uint64_t key) const;
+
+        private:
+            std::filesystem::path m_directory{};
+            uint64_t m_salt{0};
+            bool m_enabled{false};
+            counters m_counters{};
     };
 
     class shader final : public gapi::shader {
 
         private:
-            uint32_t validator(const std::string& n) const;
-            void compile(std::unordered_map<SHADER_TYPE, std::string> sources);
+            struct uniform_info{
+                uint32_t hash{0};
+                int32_t location{-1};
+                GLenum type{GL_NONE};
+                int32_t count{0};
+                uint32_t offset{0};
+                uint32_t size{0};
+            };
+
+            struct build{
+                uint32_t program{0};
+                std::vector<uint32_t> shaders{};
+                program_cache* cache{nullptr};
+                uint64_t key{0};
+                std::chrono::steady_clock::time_point start{};
+            };
+
+        private:
+            void reflect();
+            bool changed(gapi::uniform_handle h, const void* v, uint32_t size) const;
+            void compile(std::unordered_map<SHADER_TYPE, std::string> sources, bool deferred);
+            void finish();
             std::string read_file(const std::filesystem::path& file_path) const;
             std::unordered_map<SHADER_TYPE, std::string> pre_process(const std::string& src) const;
 
         public:
-            shader(const std::string& sname, const std::filesystem::path& path);
-            shader(const std::string& sname, const std::filesystem::path& vertex, const std::filesystem::path& fragment);
+            // Deferred shaders submit their compiles and link and return; poll ready() before first use.
+            shader(const std::string& sname, const std::filesystem::path& path, SHADER_BUILD mode = SHADER_BUILD::IMMEDIATE);
+            shader(const std::string& sname, const std::filesystem::path& vertex, const std::filesystem::path& fragment, SHADER_BUILD mode = SHADER_BUILD::IMMEDIATE);
+            shader(const std::string& sname, std::unordered_map<SHADER_TYPE, std::string> sources, SHADER_BUILD mode = SHADER_BUILD::IMMEDIATE);
             virtual ~shader();
 
             void bind() const override;
             void unbind() const override;
             inline virtual const std::string& name() const override { return m_name; }
+            virtual bool ready() override;
+            virtual void wait() override;
 
             virtual bool uniform(const std::string& n, uint32_t v) const override;
             virtual bool uniform(const std::string& n, float v) const override;
@@ -191,59 +704,393 @@ namespace gapi::opengl{
             virtual bool uniform(const std::string& n, const glm::mat2& v) const override;
             virtual bool uniform(const std::string& n, const glm::mat3& v) const override;
             virtual bool uniform(const std::string& n, const glm::mat4& v) const override;
-            inline uint32_t id() const { return m_id; }
-            inline uint32_t uniformloc(const std::string& n) const { return glGetUniformLocation(m_id, n.c_str()); }
+            virtual bool block(std::string_view n, uint32_t binding) const override;
+            virtual gapi::uniform_handle handle(std::string_view n) const override;
+            virtual gapi::uniform_handle handle(uint32_t name_hash) const override;
+            virtual bool uniform(gapi::uniform_handle h, uint32_t v) const override;
+            virtual bool uniform(gapi::uniform_handle h, float v) const override;
+            virtual bool uniform(gapi::uniform_handle h, const glm::vec2& v) const override;
+            virtual bool uniform(gapi::uniform_handle h, const glm::vec3& v) const override;
+            virtual bool uniform(gapi::uniform_handle h, const glm::vec4& v) const override;
+            virtual bool uniform(gapi::uniform_handle h, const glm::mat2& v) const override;
+            virtual bool uniform(gapi::uniform_handle h, const glm::mat3& v) const override;
+            virtual bool uniform(gapi::uniform_handle h, const glm::mat4& v) const override;
+            inline virtual uint32_t id() const override { return m_id; }
+            uint32_t uniformloc(const std::string& n) const;
 
         private:
             uint32_t m_id{0};
             std::string m_name{};
+            std::unique_ptr<build> m_build{};
+            std::vector<uniform_info> m_uniforms{};
+            mutable std::vector<uint8_t> m_values{};
+            mutable std::vector<uint8_t> m_cached{};
     };
 
+    // Ordered so equal define sets always hash the same.
+    using shader_defines = std::map<std::string, std::string>;
+
+    // Expands #include "file" and <file> relative to the including file, then the search paths. Files with #pragma once
+    // or a classic #ifndef/#define guard are expanded once per stage set. Every #type stage gets the context's #version
+    // line followed by the injected defines, and #line directives keep compiler messages pointing at the original files.
+    class shader_preprocessor final {
+
+        public:
+            explicit shader_preprocessor(const info& gl_info, std::vector<std::filesystem::path> include_paths = {});
+
+            [[nodiscard]] std::unordered_map<SHADER_TYPE, std::string> process(const std::filesystem::path& path, const shader_defines& defines = {});
+            [[nodiscard]] std::unordered_map<SHADER_TYPE, std::string> process_source(const std::string& source, const shader_defines& defines = {});
+
+            inline void add_include_path(std::filesystem::path path) { m_include_paths.push_back(std::move(path)); }
+            // Drops cached file contents, e.g. after shader files changed on disk.
+            inline void clear() { m_files.clear(); }
+
+            // Source string numbers used in #line directives by the last process call; index 0 is the root.
+            [[nodiscard]] inline const std::vector<std::filesystem::path>& files() const { return m_sources; }
+
+        private:
+            struct expansion{
+                std::unordered_set<std::string> once{};
+                std::unordered_set<std::string> guards{};
+                std::vector<std::string> stack{};
+            };
+
+            const std::string* read(const std::filesystem::path& path);
+            std::filesystem::path resolve(const std::string& name, const std::filesystem::path& from) const;
+            void expand(const std::string& text, const std::filesystem::path& path, expansion& state, std::string& out);
+
+        private:
+            std::string m_version{};
+            std::vector<std::filesystem::path> m_include_paths{};
+            std::unordered_map<std::string, std::string> m_files{};
+            std::vector<std::filesystem::path> m_sources{};
+    };
+
+    // Permutations of one #type shader file. A variant is preprocessed and compiled the first time its define set is
+    // requested and shared afterwards.
+    class shader_variants final {
+
+        public:
+            shader_variants(std::string sname, std::filesystem::path path, std::shared_ptr<shader_preprocessor> preprocessor, SHADER_BUILD mode = SHADER_BUILD::IMMEDIATE);
+
+            [[nodiscard]] std::shared_ptr<shader> get(const shader_defines& defines = {});
+            [[nodiscard]] uint64_t key(const shader_defines& defines) const;
+
+            inline void clear() { m_variants.clear(); }
+            [[nodiscard]] inline size_t size() const { return m_variants.size(); }
+            [[nodiscard]] inline const std::string& name() const { return m_name; }
+
+        private:
+            std::string m_name{};
+            std::filesystem::path m_path{};
+            std::shared_ptr<shader_preprocessor> m_preprocessor{};
+            SHADER_BUILD m_mode{SHADER_BUILD::IMMEDIATE};
+            std::unordered_map<uint64_t, std::shared_ptr<shader>> m_variants{};
+    };
+
+    struct image_data{
+        int32_t width{0};
+        int32_t height{0};
+        int32_t channels{0};
+        std::unique_ptr<uint8_t, void(*)(void*)> pixels{nullptr, stbi_image_free};
+        std::vector<gmip::level> mips{};
+
+        [[nodiscard]] inline bool valid() const { return pixels != nullptr; }
+        [[nodiscard]] inline size_t size() const { return size_t(width) * height * channels; }
+        [[nodiscard]] inline size_t bytes() const {
+            size_t total = size();
+            for(const auto& mip : mips) total += mip.pixels.size();
+            return total;
+        }
+    };
+
+    // Thread-safe: flips rows itself instead of using stb's global flip state.
+    [[nodiscard]] image_data decode_image(const std::filesystem::path& path, bool flip = true);
+    void generate_mips(image_data& image, const gmip::options& options = {});
+    [[nodiscard]] image_data allocate_image(int32_t width, int32_t height, int32_t channels);
+
+    struct compressed_format{
+        uint32_t internal{0};
+        uint32_t block_width{4};
+        uint32_t block_height{4};
+        uint32_t block_bytes{0};
+        int32_t channels{0};
+
+        [[nodiscard]] inline bool valid() const { return internal != 0; }
+        [[nodiscard]] inline size_t level_size(int32_t width, int32_t height) const {
+            return size_t((width + block_width - 1) / block_width) * ((height + block_height - 1) / block_height) * block_bytes;
+        }
+    };
+
+    struct compressed_image{
+        struct level{
+            const uint8_t* data{nullptr};
+            size_t size{0};
+            int32_t width{0};
+            int32_t height{0};
+        };
+
+        gapi::mapped_file file{};
+        compressed_format format{};
+        int32_t width{0};
+        int32_t height{0};
+        std::vector<level> levels{};
+
+        [[nodiscard]] inline bool valid() const { return format.valid() && !levels.empty(); }
+        [[nodiscard]] size_t bytes() const;
+    };
+
+    // Single-layer 2D KTX2 (no supercompression) and DDS (FourCC or DX10 header); levels point into the mapping.
+    // Blocks are uploaded as stored, so unlike decode_image() no vertical flip is applied.
+    [[nodiscard]] compressed_image load_compressed(const std::filesystem::path& path);
+    [[nodiscard]] bool is_compressed_container(const std::filesystem::path& path);
+
     class texture_2d final : public gapi::texture {
 
         public:
             texture_2d(std::filesystem::path path, TEXTURE_FILTER filter, TEXTURE_WRAP wrap,  bool flip = true);
+            texture_2d(TEXTURE_FILTER filter, TEXTURE_WRAP wrap);
+            texture_2d(const compressed_image& image, TEXTURE_FILTER filter, TEXTURE_WRAP wrap);
             virtual ~texture_2d();
 
             virtual void bind(uint32_t slot = 0) const override;
             [[maybe_unused]] virtual void unbind() const override;
 
+            void upload(image_data&& image);
+            void upload(const compressed_image& image);
+            void evict();
+            [[nodiscard]] inline bool ready() const { return m_ready; }
+            [[nodiscard]] inline bool evicted() const { return m_evicted; }
+            [[nodiscard]] bool consume_request();
+            [[nodiscard]] inline bool mipmapped() const { return m_filter == TEX_FILTER_NEAREST_MIPMAP || m_filter == TEX_FILTER_LINEAR_MIPMAP; }
+            [[nodiscard]] inline uint64_t last_bind() const { return m_last_bind; }
+            [[nodiscard]] inline size_t bytes() const { return m_ready ? m_bytes : 4; }
+
+            [[nodiscard]] static uint64_t clock();
+
             [[maybe_unused]] virtual uint32_t id() const override { return m_id; }
             [[maybe_unused]] virtual int32_t width() const override { return m_width; }
             [[maybe_unused]] virtual int32_t height() const override { return m_height; }
             [[maybe_unused]] virtual int32_t channels() const override { return m_channels; }
-            [[maybe_unused]] virtual uint8_t* data() const override { return m_data; }
+            // Pixels are not kept after upload; the first call reads level 0 back from the GPU.
+            [[maybe_unused]] virtual uint8_t* data() const override;
         
         private:
+            void create(TEXTURE_FILTER filter, TEXTURE_WRAP wrap);
+            void recreate();
+
+        private:
+            uint32_t m_id{0};
+            uint32_t m_levels{1};
             int32_t m_width{0};
             int32_t m_height{0};
             int32_t m_channels{0};
-            uint32_t m_id{0};
-            std::string m_path{};
-            uint8_t* m_data{nullptr};
+            TEXTURE_FILTER m_filter{TEX_FILTER_LINEAR};
+            TEXTURE_WRAP m_wrap{TEX_WRAP_REPEAT};
+            size_t m_bytes{0};
+            bool m_ready{false};
+            bool m_evicted{false};
+            bool m_immutable{false};
+            bool m_compressed{false};
+            mutable bool m_requested{false};
+            mutable uint64_t m_last_bind{0};
+            mutable std::vector<uint8_t> m_readback{};
             TEXTURE_TYPE m_type{TEXTURE_2D};
     };
 
+    // Decodes on worker threads; textures bind a 1x1 placeholder until update() uploads them on the GL thread.
+    class texture_loader{
+
+        public:
+            explicit texture_loader(uint32_t threads = 0) : m_pool(threads) {}
+            texture_loader(const texture_loader&) = delete;
+            texture_loader& operator=(const texture_loader&) = delete;
+            ~texture_loader() = default;
+
+            [[nodiscard]] std::shared_ptr<texture_2d> load(std::filesystem::path path, TEXTURE_FILTER filter, TEXTURE_WRAP wrap, bool flip = true);
+            void reload(const std::shared_ptr<texture_2d>& texture, std::filesystem::path path, bool flip = true);
+
+            // At least one upload per call, then stops at whichever budget runs out first.
+            uint32_t update(size_t byte_budget = 8u << 20, std::chrono::microseconds time_budget = std::chrono::microseconds(2000));
+
+            [[nodiscard]] inline uint32_t pending() const { return m_pending.load(std::memory_order_relaxed); }
+
+        private:
+            struct decoded{
+                std::weak_ptr<texture_2d> texture{};
+                image_data image{};
+            };
+
+            std::mutex m_mutex{};
+            std::deque<decoded> m_decoded{};
+            std::atomic<uint32_t> m_pending{0};
+            thread_pool m_pool;
+    };
+
+    class texture_2d_array final : public gapi::texture {
+
+        public:
+            texture_2d_array(int32_t width, int32_t height, uint32_t layers, TEXTURE_FILTER filter, TEXTURE_WRAP wrap);
+            virtual ~texture_2d_array();
+
+            virtual void bind(uint32_t slot = 0) const override;
+            [[maybe_unused]] virtual void unbind() const override;
+
+            // RGBA8 texels for one layer; lower levels are built on the CPU when the filter is mipmapped.
+            void upload(uint32_t layer, const uint8_t* pixels);
+
+            [[nodiscard]] inline uint32_t layers() const { return m_layers; }
+            [[nodiscard]] inline size_t bytes() const { return m_bytes; }
+            [[maybe_unused]] virtual uint32_t id() const override { return m_id; }
+            [[maybe_unused]] virtual int32_t width() const override { return m_width; }
+            [[maybe_unused]] virtual int32_t height() const override { return m_height; }
+            [[maybe_unused]] virtual int32_t channels() const override { return 4; }
+            [[maybe_unused]] virtual uint8_t* data() const override { return nullptr; }
+
+        private:
+            uint32_t m_id{0};
+            int32_t m_width{0};
+            int32_t m_height{0};
+            uint32_t m_layers{0};
+            uint32_t m_levels{1};
+            size_t m_bytes{0};
+            TEXTURE_TYPE m_type{TEXTURE_2D_ARRAY};
+    };
+
+    struct atlas_region{
+        const gapi::texture* texture{nullptr};
+        glm::vec4 uv{0.0f, 0.0f, 1.0f, 1.0f};
+        uint32_t layer{0};
+        bool array{false};
+    };
+
+    // Images collected with add() are placed by build(): sizes shared by at least min_layers images become
+    // texture_2d_array layers, everything else is skyline-packed into RGBA pages. Regions are valid after build().
+    class texture_atlas{
+
+        public:
+            static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+            explicit texture_atlas(TEXTURE_FILTER filter = TEX_FILTER_LINEAR, int32_t page_size = 2048, int32_t padding = 2, uint32_t min_layers = 4)
+                : m_filter(filter), m_page_size(page_size), m_padding(padding), m_min_layers(min_layers) {}
+            texture_atlas(const texture_atlas&) = delete;
+            texture_atlas& operator=(const texture_atlas&) = delete;
+            ~texture_atlas() = default;
+
+            [[nodiscard]] uint32_t add(image_data&& image);
+            void build();
+
+            [[nodiscard]] inline const atlas_region& region(uint32_t id) const { return m_regions[id]; }
+            [[nodiscard]] inline size_t size() const { return m_regions.size(); }
+            [[nodiscard]] inline const std::vector<std::shared_ptr<texture_2d>>& pages() const { return m_pages; }
+            [[nodiscard]] inline const std::vector<std::shared_ptr<texture_2d_array>>& arrays() const { return m_arrays; }
+
+        private:
+            TEXTURE_FILTER m_filter{TEX_FILTER_LINEAR};
+            int32_t m_page_size{2048};
+            int32_t m_padding{2};
+            uint32_t m_min_layers{4};
+            std::vector<image_data> m_images{};
+            std::vector<atlas_region> m_regions{};
+            size_t m_built{0};
+            std::vector<std::shared_ptr<texture_2d>> m_pages{};
+            std::vector<std::shared_ptr<texture_2d_array>> m_arrays{};
+    };
+
+    // Shares one texture per (path, filter, wrap, flip). update() reloads evicted textures that were bound again,
+    // then evicts least recently bound ones until resident bytes fit the budget; unreferenced entries go first.
+    class texture_cache{
+
+        public:
+            explicit texture_cache(size_t budget = 256u << 20, std::shared_ptr<texture_loader> loader = nullptr)
+                : m_budget(budget), m_loader(std::move(loader)) {}
+            texture_cache(const texture_cache&) = delete;
+            texture_cache& operator=(const texture_cache&) = delete;
+            ~texture_cache() = default;
+
+            [[nodiscard]] std::shared_ptr<texture_2d> get(const std::filesystem::path& path, TEXTURE_FILTER filter, TEXTURE_WRAP wrap, bool flip = true);
+            void update();
+            void clear();
+
+            inline void budget(size_t bytes) { m_budget = bytes; }
+            [[nodiscard]] inline size_t budget() const { return m_budget; }
+            [[nodiscard]] inline size_t bytes() const { return m_bytes; }
+            [[nodiscard]] inline size_t size() const { return m_entries.size(); }
+
+        private:
+            struct key{
+                std::string path{};
+                TEXTURE_FILTER filter{};
+                TEXTURE_WRAP wrap{};
+                bool flip{true};
+
+                bool operator==(const key&) const = default;
+            };
+
+            struct key_hash{
+                size_t operator()(const key& k) const {
+                    return std::hash<std::string>{}(k.path) ^ (size_t(k.filter) << 1) ^ (size_t(k.wrap) << 17) ^ size_t(k.flip);
+                }
+            };
+
+            std::unordered_map<key, std::shared_ptr<texture_2d>, key_hash> m_entries{};
+            size_t m_budget{0};
+            size_t m_bytes{0};
+            uint64_t m_frame{0};
+            std::shared_ptr<texture_loader> m_loader{nullptr};
+    };
+
     class api final : public gapi::base_api {
 
         public:
             api() = default;
-            virtual ~api() = default;
+            virtual ~api();
 
             virtual void init() override;
-            virtual void draw(const std::shared_ptr<gapi::vertex_array>& va) override;
+            using gapi::base_api::draw;
+            virtual void draw(const gapi::vertex_array& va) override;
+            virtual void draw(const gapi::vertex_array& va, const gapi::draw_range& range) override;
+            virtual void draw_multi(const gapi::vertex_array& va, std::span<const gapi::draw_range> ranges) override;
             virtual void clear() override;
             virtual void clear_color(float r, float g, float b, float a) override;
+            virtual void bind_range(const gapi::buffer_range& range) override;
             virtual GAPI xapi() const override { return gapi::GAPI::OPENGL; }
+
+            void end_frame();
+            [[nodiscard]] inline const frame_stats& stats() const { return m_stats; }
+
+        private:
+            struct draw_indirect{
+                uint32_t count{0};
+                uint32_t instances{0};
+                uint32_t first{0};
+                int32_t base_vertex{0};
+                uint32_t base_instance{0};
+            };
+
+            uint32_t m_indirect{0};
+            std::vector<draw_indirect> m_commands{};
+            frame_stats m_stats{};
     };
 
     [[nodiscard]] std::shared_ptr<context> make_context(GLFWwindow* window) noexcept;
-    [[nodiscard]] std::shared_ptr<vertex_buffer> make_vertex(float* v, uint32_t s, DRAW t) noexcept;
-    [[nodiscard]] std::shared_ptr<index_buffer> make_index(uint32_t* i, size_t c, DRAW t) noexcept;
+    [[nodiscard]] std::shared_ptr<upload_context> make_upload_context(GLFWwindow* shared) noexcept;
+    [[nodiscard]] std::shared_ptr<profiler> make_profiler() noexcept;
+    [[nodiscard]] std::shared_ptr<vertex_buffer> make_vertex(const void* v, uint32_t s, DRAW t) noexcept;
+    [[nodiscard]] std::shared_ptr<index_buffer> make_index(const void* i, uint32_t count, gapi::INDEX type, DRAW t) noexcept;
+    [[nodiscard]] std::shared_ptr<index_buffer> make_index(const uint32_t* i, uint32_t count, uint32_t vertex_count, DRAW t) noexcept;
     [[nodiscard]] std::shared_ptr<vertex_array> make_array() noexcept;
     [[nodiscard]] std::shared_ptr<texture_2d> make_texture2d(std::filesystem::path path, TEXTURE_FILTER filter, TEXTURE_WRAP wrap,  bool flip = true) noexcept;
-    [[nodiscard]] std::shared_ptr<shader> make_shader(const std::string& sname, const std::filesystem::path& path) noexcept;
-    [[nodiscard]] std::shared_ptr<shader> make_shader(const std::string& sname, const std::filesystem::path& vertex, const std::filesystem::path& fragment) noexcept;
+    [[nodiscard]] std::shared_ptr<texture_2d> make_texture2d(const compressed_image& image, TEXTURE_FILTER filter, TEXTURE_WRAP wrap) noexcept;
+    [[nodiscard]] std::shared_ptr<texture_2d_array> make_texture2d_array(int32_t width, int32_t height, uint32_t layers, TEXTURE_FILTER filter, TEXTURE_WRAP wrap) noexcept;
+    [[nodiscard]] std::shared_ptr<texture_atlas> make_texture_atlas(TEXTURE_FILTER filter = TEX_FILTER_LINEAR, int32_t page_size = 2048, int32_t padding = 2, uint32_t min_layers = 4) noexcept;
+    [[nodiscard]] std::shared_ptr<texture_loader> make_texture_loader(uint32_t threads = 0) noexcept;
+    [[nodiscard]] std::shared_ptr<texture_cache> make_texture_cache(size_t budget, std::shared_ptr<texture_loader> loader = nullptr) noexcept;
+    [[nodiscard]] std::shared_ptr<program_cache> make_program_cache(std::filesystem::path directory, const info& gl_info) noexcept;
+    [[nodiscard]] std::shared_ptr<shader> make_shader(const std::string& sname, const std::filesystem::path& path, SHADER_BUILD mode = SHADER_BUILD::IMMEDIATE) noexcept;
+    [[nodiscard]] std::shared_ptr<shader> make_shader(const std::string& sname, const std::filesystem::path& vertex, const std::filesystem::path& fragment, SHADER_BUILD mode = SHADER_BUILD::IMMEDIATE) noexcept;
+    [[nodiscard]] std::shared_ptr<shader_preprocessor> make_shader_preprocessor(const info& gl_info, std::vector<std::filesystem::path> include_paths = {}) noexcept;
+    [[nodiscard]] std::shared_ptr<shader_variants> make_shader_variants(std::string sname, std::filesystem::path path, std::shared_ptr<shader_preprocessor> preprocessor, SHADER_BUILD mode = SHADER_BUILD::IMMEDIATE) noexcept;
     
 }
 
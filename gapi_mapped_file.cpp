@@ -0,0 +1,93 @@
+#include "gapi_mapped_file.hpp"
+
+#include <utility>
+
+#if defined(_WIN32) || defined(_WIN64)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gapi{
+
+#if defined(_WIN32) || defined(_WIN64)
+    mapped_file::mapped_file(const std::filesystem::path& path){
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(file == INVALID_HANDLE_VALUE) return;
+
+        LARGE_INTEGER size{};
+        if(!GetFileSizeEx(file, &size) || size.QuadPart == 0){
+            CloseHandle(file);
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(!mapping){
+            CloseHandle(file);
+            return;
+        }
+
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        m_size = m_data ? static_cast<size_t>(size.QuadPart) : 0;
+        m_file = file;
+        m_mapping = mapping;
+    }
+
+    void mapped_file::close(){
+        if(m_data) UnmapViewOfFile(m_data);
+        if(m_mapping) CloseHandle(m_mapping);
+        if(m_file) CloseHandle(m_file);
+        m_data = nullptr;
+        m_size = 0;
+        m_mapping = nullptr;
+        m_file = nullptr;
+    }
+#else
+    mapped_file::mapped_file(const std::filesystem::path& path){
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) return;
+
+        struct stat st{};
+        if(::fstat(fd, &st) == 0 && st.st_size > 0){
+            void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data != MAP_FAILED){
+                m_data = static_cast<const uint8_t*>(data);
+                m_size = static_cast<size_t>(st.st_size);
+            }
+        }
+
+        ::close(fd);
+    }
+
+    void mapped_file::close(){
+        if(m_data) ::munmap(const_cast<uint8_t*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+#endif
+
+    mapped_file::mapped_file(mapped_file&& other) noexcept{
+        *this = std::move(other);
+    }
+
+    mapped_file& mapped_file::operator=(mapped_file&& other) noexcept{
+        if(this == &other) return *this;
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#if defined(_WIN32) || defined(_WIN64)
+        m_file = std::exchange(other.m_file, nullptr);
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+        return *this;
+    }
+
+    mapped_file::~mapped_file(){
+        close();
+    }
+}
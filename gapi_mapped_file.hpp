@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace gapi{
+
+    // Read-only memory mapping of a whole file; empty when the file cannot be opened.
+    class mapped_file final {
+
+        public:
+            mapped_file() = default;
+            explicit mapped_file(const std::filesystem::path& path);
+            mapped_file(mapped_file&& other) noexcept;
+            mapped_file& operator=(mapped_file&& other) noexcept;
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+            ~mapped_file();
+
+            [[nodiscard]] inline const uint8_t* data() const { return m_data; }
+            [[nodiscard]] inline size_t size() const { return m_size; }
+            [[nodiscard]] inline bool valid() const { return m_data != nullptr; }
+            [[nodiscard]] inline std::span<const uint8_t> bytes() const { return {m_data, m_size}; }
+
+        private:
+            void close();
+
+        private:
+            const uint8_t* m_data{nullptr};
+            size_t m_size{0};
+#if defined(_WIN32) || defined(_WIN64)
+            void* m_file{nullptr};
+            void* m_mapping{nullptr};
+#endif
+    };
+}
@@ -0,0 +1,369 @@
+#include "gapi_mesh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace gapi::mesh{
+
+    static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+    static uint32_t hash_bytes(const uint8_t* data, uint32_t size){
+        uint32_t h = 2166136261u;
+        for(uint32_t i = 0; i < size; i++){
+            h ^= data[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    uint32_t weld(const void* vertices, uint32_t vertex_count, uint32_t stride, std::vector<uint32_t>& remap){
+        const uint8_t* data = static_cast<const uint8_t*>(vertices);
+        remap.assign(vertex_count, INVALID);
+
+        uint32_t buckets = 1;
+        while(buckets < vertex_count * 2) buckets <<= 1;
+        std::vector<uint32_t> table(buckets, INVALID);
+
+        uint32_t unique = 0;
+        for(uint32_t i = 0; i < vertex_count; i++){
+            const uint8_t* vertex = data + size_t(i) * stride;
+            uint32_t slot = hash_bytes(vertex, stride) & (buckets - 1);
+
+            for(uint32_t probe = 1; table[slot] != INVALID; probe++){
+                if(std::memcmp(data + size_t(table[slot]) * stride, vertex, stride) == 0) break;
+                slot = (slot + probe) & (buckets - 1);
+            }
+
+            if(table[slot] == INVALID){
+                table[slot] = i;
+                remap[i] = unique++;
+            }
+            else remap[i] = remap[table[slot]];
+        }
+
+        return unique;
+    }
+
+    void remap_vertices(void* dst, const void* src, uint32_t vertex_count, uint32_t stride, const std::vector<uint32_t>& remap){
+        uint8_t* out = static_cast<uint8_t*>(dst);
+        const uint8_t* in = static_cast<const uint8_t*>(src);
+        for(uint32_t i = 0; i < vertex_count; i++){
+            if(remap[i] != INVALID)
+                std::memcpy(out + size_t(remap[i]) * stride, in + size_t(i) * stride, stride);
+        }
+    }
+
+    void remap_indices(uint32_t* dst, const uint32_t* src, uint32_t index_count, const std::vector<uint32_t>& remap){
+        for(uint32_t i = 0; i < index_count; i++) dst[i] = remap[src[i]];
+    }
+
+    // Forsyth, "Linear-Speed Vertex Cache Optimisation"
+    static constexpr uint32_t CACHE_SIZE = 32;
+    static constexpr uint32_t MAX_VALENCE = 32;
+
+    struct score_tables{
+        std::array<float, CACHE_SIZE + 1> cache{};
+        std::array<float, MAX_VALENCE + 1> valence{};
+
+        score_tables(){
+            for(uint32_t i = 0; i < CACHE_SIZE; i++){
+                cache[i + 1] = i < 3 ? 0.75f : std::pow(1.0f - float(i - 3) / float(CACHE_SIZE - 3), 1.5f);
+            }
+            for(uint32_t i = 1; i <= MAX_VALENCE; i++) valence[i] = 2.0f / std::sqrt(float(i));
+        }
+
+        [[nodiscard]] float score(int32_t position, uint32_t live) const {
+            if(live == 0) return -1.0f;
+            return cache[position + 1] + valence[std::min(live, MAX_VALENCE)];
+        }
+    };
+
+    void optimize_vertex_cache(uint32_t* dst, const uint32_t* indices, uint32_t index_count, uint32_t vertex_count){
+        static const score_tables tables;
+        const uint32_t tri_count = index_count / 3;
+        if(tri_count == 0) return;
+
+        std::vector<uint32_t> live(vertex_count, 0);
+        for(uint32_t i = 0; i < tri_count * 3; i++) live[indices[i]]++;
+
+        std::vector<uint32_t> offsets(vertex_count + 1, 0);
+        for(uint32_t v = 0; v < vertex_count; v++) offsets[v + 1] = offsets[v] + live[v];
+
+        std::vector<uint32_t> adjacency(tri_count * 3);
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for(uint32_t i = 0; i < tri_count * 3; i++) adjacency[fill[indices[i]]++] = i / 3;
+
+        std::vector<int32_t> position(vertex_count, -1);
+        std::vector<float> vertex_score(vertex_count);
+        for(uint32_t v = 0; v < vertex_count; v++) vertex_score[v] = tables.score(-1, live[v]);
+
+        std::vector<float> tri_score(tri_count);
+        std::vector<uint8_t> emitted(tri_count, 0);
+        for(uint32_t t = 0; t < tri_count; t++){
+            const uint32_t* tri = indices + t * 3;
+            tri_score[t] = vertex_score[tri[0]] + vertex_score[tri[1]] + vertex_score[tri[2]];
+        }
+
+        std::vector<uint32_t> cache, next;
+        cache.reserve(CACHE_SIZE + 3);
+        next.reserve(CACHE_SIZE + 3);
+
+        uint32_t best = uint32_t(std::max_element(tri_score.begin(), tri_score.end()) - tri_score.begin());
+        uint32_t cursor = 0;
+
+        for(uint32_t out = 0; out < tri_count; out++){
+            if(best == INVALID){
+                while(emitted[cursor]) cursor++;
+                best = cursor;
+            }
+
+            const uint32_t* tri = indices + best * 3;
+            std::memcpy(dst + out * 3, tri, sizeof(uint32_t) * 3);
+            emitted[best] = 1;
+
+            next.clear();
+            for(uint32_t k = 0; k < 3; k++){
+                uint32_t v = tri[k];
+                uint32_t* begin = adjacency.data() + offsets[v];
+                uint32_t* end = begin + live[v];
+                uint32_t* it = std::find(begin, end, best);
+                *it = *(end - 1);
+                live[v]--;
+
+                if(std::find(next.begin(), next.end(), v) == next.end()) next.push_back(v);
+            }
+
+            for(uint32_t v : cache){
+                if(std::find(next.begin(), next.end(), v) == next.end()) next.push_back(v);
+            }
+
+            for(uint32_t i = 0; i < next.size(); i++){
+                uint32_t v = next[i];
+                position[v] = i < CACHE_SIZE ? int32_t(i) : -1;
+
+                float score = tables.score(position[v], live[v]);
+                float delta = score - vertex_score[v];
+                vertex_score[v] = score;
+
+                for(uint32_t a = offsets[v]; a < offsets[v] + live[v]; a++) tri_score[adjacency[a]] += delta;
+            }
+
+            if(next.size() > CACHE_SIZE) next.resize(CACHE_SIZE);
+
+            best = INVALID;
+            float best_score = -1.0f;
+            for(uint32_t v : next){
+                for(uint32_t a = offsets[v]; a < offsets[v] + live[v]; a++){
+                    uint32_t t = adjacency[a];
+                    if(tri_score[t] > best_score){
+                        best_score = tri_score[t];
+                        best = t;
+                    }
+                }
+            }
+
+            cache.swap(next);
+        }
+    }
+
+    struct vertex_fifo{
+        std::vector<uint32_t> stamps;
+        uint32_t size;
+        uint32_t time;
+
+        vertex_fifo(uint32_t vertex_count, uint32_t cache_size) : stamps(vertex_count, 0), size(cache_size), time(cache_size + 1) {}
+
+        void reset(){ time += size + 1; }
+
+        bool miss(uint32_t v){
+            if(time - stamps[v] <= size) return false;
+            stamps[v] = time++;
+            return true;
+        }
+
+        [[nodiscard]] uint32_t misses(const uint32_t* tri){
+            return uint32_t(miss(tri[0])) + uint32_t(miss(tri[1])) + uint32_t(miss(tri[2]));
+        }
+    };
+
+    static std::array<float, 3> load_position(const uint8_t* vertices, uint32_t v, uint32_t stride, uint32_t offset){
+        std::array<float, 3> p;
+        std::memcpy(p.data(), vertices + size_t(v) * stride + offset, sizeof(p));
+        return p;
+    }
+
+    // Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+    void optimize_overdraw(uint32_t* dst, const uint32_t* indices, uint32_t index_count, const void* vertices, uint32_t vertex_count, uint32_t stride, uint32_t position_offset, float threshold){
+        const uint32_t tri_count = index_count / 3;
+        if(tri_count == 0) return;
+
+        constexpr uint32_t fifo_size = 16;
+        vertex_fifo fifo(vertex_count, fifo_size);
+
+        // The first triangle always opens a cluster, even when a degenerate one misses fewer than three times.
+        std::vector<uint32_t> hard;
+        for(uint32_t t = 0; t < tri_count; t++){
+            const uint32_t misses = fifo.misses(indices + t * 3);
+            if(t == 0 || misses == 3) hard.push_back(t);
+        }
+        hard.push_back(tri_count);
+
+        std::vector<uint32_t> clusters;
+        for(size_t c = 0; c + 1 < hard.size(); c++){
+            const uint32_t begin = hard[c], end = hard[c + 1];
+
+            fifo.reset();
+            uint32_t total = 0;
+            for(uint32_t t = begin; t < end; t++) total += fifo.misses(indices + t * 3);
+            const float limit = threshold * float(total) / float(end - begin);
+
+            fifo.reset();
+            clusters.push_back(begin);
+            uint32_t start = begin, misses = 0;
+            for(uint32_t t = begin; t < end; t++){
+                misses += fifo.misses(indices + t * 3);
+                if(t + 1 < end && float(misses) / float(t + 1 - start) <= limit){
+                    clusters.push_back(t + 1);
+                    start = t + 1;
+                    misses = 0;
+                    fifo.reset();
+                }
+            }
+        }
+        clusters.push_back(tri_count);
+
+        const uint8_t* data = static_cast<const uint8_t*>(vertices);
+        const size_t cluster_count = clusters.size() - 1;
+        std::vector<std::array<float, 6>> shapes(cluster_count);
+        std::array<float, 3> center{};
+        float mesh_area = 0.0f;
+
+        for(size_t c = 0; c < cluster_count; c++){
+            std::array<float, 6> shape{};
+            float area = 0.0f;
+
+            for(uint32_t t = clusters[c]; t < clusters[c + 1]; t++){
+                auto a = load_position(data, indices[t * 3 + 0], stride, position_offset);
+                auto b = load_position(data, indices[t * 3 + 1], stride, position_offset);
+                auto d = load_position(data, indices[t * 3 + 2], stride, position_offset);
+
+                float e0[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                float e1[3] = {d[0] - a[0], d[1] - a[1], d[2] - a[2]};
+                float n[3] = {e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0]};
+                float w = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                for(int k = 0; k < 3; k++){
+                    shape[k] += (a[k] + b[k] + d[k]) * (w / 3.0f);
+                    shape[k + 3] += n[k];
+                }
+                area += w;
+            }
+
+            float inv = area > 0.0f ? 1.0f / area : 0.0f;
+            for(int k = 0; k < 3; k++){
+                center[k] += shape[k];
+                shape[k] *= inv;
+            }
+            mesh_area += area;
+
+            float length = std::sqrt(shape[3] * shape[3] + shape[4] * shape[4] + shape[5] * shape[5]);
+            float inv_length = length > 0.0f ? 1.0f / length : 0.0f;
+            for(int k = 3; k < 6; k++) shape[k] *= inv_length;
+
+            shapes[c] = shape;
+        }
+
+        float inv_area = mesh_area > 0.0f ? 1.0f / mesh_area : 0.0f;
+        for(auto& k : center) k *= inv_area;
+
+        std::vector<float> keys(cluster_count);
+        for(size_t c = 0; c < cluster_count; c++){
+            const auto& s = shapes[c];
+            keys[c] = (s[0] - center[0]) * s[3] + (s[1] - center[1]) * s[4] + (s[2] - center[2]) * s[5];
+        }
+
+        std::vector<uint32_t> order(cluster_count);
+        for(uint32_t c = 0; c < cluster_count; c++) order[c] = c;
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){ return keys[a] > keys[b]; });
+
+        std::vector<uint32_t> scratch;
+        uint32_t* out = dst;
+        if(dst == indices){
+            scratch.assign(indices, indices + tri_count * 3);
+            indices = scratch.data();
+        }
+
+        for(uint32_t c : order){
+            const uint32_t count = (clusters[c + 1] - clusters[c]) * 3;
+            std::memcpy(out, indices + clusters[c] * 3, count * sizeof(uint32_t));
+            out += count;
+        }
+    }
+
+    uint32_t optimize_vertex_fetch(void* dst, uint32_t* indices, uint32_t index_count, const void* vertices, uint32_t vertex_count, uint32_t stride){
+        std::vector<uint32_t> remap(vertex_count, INVALID);
+        uint8_t* out = static_cast<uint8_t*>(dst);
+        const uint8_t* in = static_cast<const uint8_t*>(vertices);
+
+        uint32_t next = 0;
+        for(uint32_t i = 0; i < index_count; i++){
+            uint32_t& r = remap[indices[i]];
+            if(r == INVALID){
+                std::memcpy(out + size_t(next) * stride, in + size_t(indices[i]) * stride, stride);
+                r = next++;
+            }
+            indices[i] = r;
+        }
+
+        return next;
+    }
+
+    cache_stats analyze_vertex_cache(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count, uint32_t cache_size){
+        cache_stats stats{};
+        const uint32_t tri_count = index_count / 3;
+        if(tri_count == 0) return stats;
+
+        vertex_fifo fifo(vertex_count, cache_size);
+        std::vector<uint8_t> used(vertex_count, 0);
+        uint32_t unique = 0;
+
+        for(uint32_t i = 0; i < tri_count * 3; i++){
+            stats.transforms += uint32_t(fifo.miss(indices[i]));
+            if(!used[indices[i]]){
+                used[indices[i]] = 1;
+                unique++;
+            }
+        }
+
+        stats.acmr = float(stats.transforms) / float(tri_count);
+        stats.atvr = float(stats.transforms) / float(unique);
+        return stats;
+    }
+
+    mesh_data optimize(const void* vertices, uint32_t vertex_count, uint32_t stride, const uint32_t* indices, uint32_t index_count, uint32_t position_offset){
+        mesh_data mesh{};
+        mesh.stride = stride;
+        index_count -= index_count % 3;
+
+        std::vector<uint32_t> remap;
+        const uint32_t unique = weld(vertices, vertex_count, stride, remap);
+
+        std::vector<uint8_t> welded(size_t(unique) * stride);
+        remap_vertices(welded.data(), vertices, vertex_count, stride, remap);
+
+        std::vector<uint32_t> scratch(index_count);
+        remap_indices(scratch.data(), indices, index_count, remap);
+
+        mesh.indices.resize(index_count);
+        optimize_vertex_cache(mesh.indices.data(), scratch.data(), index_count, unique);
+        optimize_overdraw(mesh.indices.data(), mesh.indices.data(), index_count, welded.data(), unique, stride, position_offset);
+
+        mesh.vertices.resize(welded.size());
+        mesh.vertex_count = optimize_vertex_fetch(mesh.vertices.data(), mesh.indices.data(), index_count, welded.data(), unique, stride);
+        mesh.vertices.resize(size_t(mesh.vertex_count) * stride);
+
+        return mesh;
+    }
+}
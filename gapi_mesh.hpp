@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace gapi::mesh{
+
+    struct cache_stats{
+        uint32_t transforms{0};
+        float acmr{0.0f};
+        float atvr{0.0f};
+    };
+
+    struct mesh_data{
+        std::vector<uint8_t> vertices{};
+        std::vector<uint32_t> indices{};
+        uint32_t vertex_count{0};
+        uint32_t stride{0};
+    };
+
+    [[nodiscard]] uint32_t weld(const void* vertices, uint32_t vertex_count, uint32_t stride, std::vector<uint32_t>& remap);
+    void remap_vertices(void* dst, const void* src, uint32_t vertex_count, uint32_t stride, const std::vector<uint32_t>& remap);
+    void remap_indices(uint32_t* dst, const uint32_t* src, uint32_t index_count, const std::vector<uint32_t>& remap);
+
+    void optimize_vertex_cache(uint32_t* dst, const uint32_t* indices, uint32_t index_count, uint32_t vertex_count);
+    void optimize_overdraw(uint32_t* dst, const uint32_t* indices, uint32_t index_count, const void* vertices, uint32_t vertex_count, uint32_t stride, uint32_t position_offset = 0, float threshold = 1.05f);
+    [[nodiscard]] uint32_t optimize_vertex_fetch(void* dst, uint32_t* indices, uint32_t index_count, const void* vertices, uint32_t vertex_count, uint32_t stride);
+
+    [[nodiscard]] cache_stats analyze_vertex_cache(const uint32_t* indices, uint32_t index_count, uint32_t vertex_count, uint32_t cache_size = 16);
+
+    // Weld, vertex cache, overdraw and fetch passes in order; positions are three floats at position_offset.
+    [[nodiscard]] mesh_data optimize(const void* vertices, uint32_t vertex_count, uint32_t stride, const uint32_t* indices, uint32_t index_count, uint32_t position_offset = 0);
+}
+
+namespace gmesh = gapi::mesh;
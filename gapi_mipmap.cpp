@@ -0,0 +1,198 @@
+#include "gapi_mipmap.hpp"
+#include "gapi_thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAPI_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define GAPI_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+namespace gapi::mip{
+
+    static constexpr int32_t TILE_ROWS = 32;
+    static constexpr int32_t PARALLEL_TEXELS = 128 * 128;
+
+    static float srgb_to_linear(float c){
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static float linear_to_srgb(float c){
+        return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    struct srgb_tables{
+        static constexpr int32_t ENCODE_SIZE = 4096;
+        std::array<float, 256> decode{};
+        std::array<uint8_t, ENCODE_SIZE> encode{};
+
+        srgb_tables(){
+            for(int32_t i = 0; i < 256; i++) decode[i] = srgb_to_linear(i / 255.0f);
+            for(int32_t i = 0; i < ENCODE_SIZE; i++)
+                encode[i] = static_cast<uint8_t>(std::lround(linear_to_srgb(i / float(ENCODE_SIZE - 1)) * 255.0f));
+        }
+    };
+
+    static const srgb_tables& tables(){
+        static const srgb_tables t;
+        return t;
+    }
+
+    static inline bool is_alpha(int32_t channel, int32_t channels){
+        return (channels == 2 || channels == 4) && channel == channels - 1;
+    }
+
+    static void downsample_row_scalar(const uint8_t* r0, const uint8_t* r1, int32_t width, int32_t channels, uint8_t* dst, bool srgb, int32_t x_begin, int32_t x_end){
+        const auto& t = tables();
+        for(int32_t x = x_begin; x < x_end; x++){
+            const int32_t sx0 = 2 * x * channels;
+            const int32_t sx1 = std::min(2 * x + 1, width - 1) * channels;
+            for(int32_t c = 0; c < channels; c++){
+                if(srgb && !is_alpha(c, channels)){
+                    float sum = t.decode[r0[sx0 + c]] + t.decode[r0[sx1 + c]] + t.decode[r1[sx0 + c]] + t.decode[r1[sx1 + c]];
+                    dst[x * channels + c] = t.encode[static_cast<int32_t>(sum * (0.25f * (srgb_tables::ENCODE_SIZE - 1)) + 0.5f)];
+                }
+                else{
+                    dst[x * channels + c] = static_cast<uint8_t>((r0[sx0 + c] + r0[sx1 + c] + r1[sx0 + c] + r1[sx1 + c] + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    static int32_t downsample_row_rgba(const uint8_t* r0, const uint8_t* r1, uint8_t* dst, int32_t count){
+        int32_t x = 0;
+#ifdef GAPI_SIMD_AVX2
+        const __m256i zero256 = _mm256_setzero_si256(), round256 = _mm256_set1_epi16(2);
+        for(; x + 4 <= count; x += 4){
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r0 + x * 8));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r1 + x * 8));
+            __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero256), _mm256_unpacklo_epi8(b, zero256));
+            __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero256), _mm256_unpackhi_epi8(b, zero256));
+            lo = _mm256_add_epi16(lo, _mm256_srli_si256(lo, 8));
+            hi = _mm256_add_epi16(hi, _mm256_srli_si256(hi, 8));
+            __m256i sum = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), round256), 2);
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(sum, sum), 0x08);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm256_castsi256_si128(packed));
+        }
+#endif
+#ifdef GAPI_SIMD_SSE2
+        const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi16(2);
+        for(; x + 2 <= count; x += 2){
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + x * 8));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + x * 8));
+            __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+            hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+            __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), round), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(sum, sum));
+        }
+#endif
+        return x;
+    }
+
+    void downsample(const uint8_t* src, int32_t width, int32_t height, int32_t channels, uint8_t* dst, bool srgb, int32_t row_begin, int32_t row_end) noexcept {
+        const int32_t dst_width = std::max(1, width / 2);
+        const size_t pitch = size_t(width) * channels;
+
+        for(int32_t y = row_begin; y < row_end; y++){
+            const uint8_t* r0 = src + size_t(2 * y) * pitch;
+            const uint8_t* r1 = src + size_t(std::min(2 * y + 1, height - 1)) * pitch;
+            uint8_t* out = dst + size_t(y) * dst_width * channels;
+
+            int32_t x = 0;
+            if(channels == 4 && !srgb && width > 1) x = downsample_row_rgba(r0, r1, out, dst_width);
+            downsample_row_scalar(r0, r1, width, channels, out, srgb, x, dst_width);
+        }
+    }
+
+    void downsample_reference(const uint8_t* src, int32_t width, int32_t height, int32_t channels, uint8_t* dst, bool srgb) noexcept {
+        const int32_t dst_width = std::max(1, width / 2), dst_height = std::max(1, height / 2);
+        for(int32_t y = 0; y < dst_height; y++){
+            for(int32_t x = 0; x < dst_width; x++){
+                const int32_t xs[2] = {2 * x, std::min(2 * x + 1, width - 1)};
+                const int32_t ys[2] = {2 * y, std::min(2 * y + 1, height - 1)};
+                for(int32_t c = 0; c < channels; c++){
+                    float sum = 0.0f;
+                    for(int32_t sy : ys){
+                        for(int32_t sx : xs){
+                            float v = src[(size_t(sy) * width + sx) * channels + c] / 255.0f;
+                            sum += srgb && !is_alpha(c, channels) ? srgb_to_linear(v) : v;
+                        }
+                    }
+                    float v = sum * 0.25f;
+                    if(srgb && !is_alpha(c, channels)) v = linear_to_srgb(v);
+                    dst[(size_t(y) * dst_width + x) * channels + c] = static_cast<uint8_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+                }
+            }
+        }
+    }
+
+    float coverage(const uint8_t* pixels, int32_t width, int32_t height, float reference, float scale) noexcept {
+        const size_t count = size_t(width) * height;
+        if(count == 0) return 0.0f;
+
+        const float threshold = reference * 255.0f;
+        size_t covered = 0;
+        for(size_t i = 0; i < count; i++) covered += pixels[i * 4 + 3] * scale > threshold;
+        return float(covered) / float(count);
+    }
+
+    // Castano, "Computing Alpha Mipmaps": search the alpha scale that restores the base level's coverage.
+    void scale_coverage(uint8_t* pixels, int32_t width, int32_t height, float reference, float target) noexcept {
+        float lo = 0.0f, hi = 4.0f, scale = 1.0f;
+        for(int32_t i = 0; i < 10; i++){
+            scale = 0.5f * (lo + hi);
+            float current = coverage(pixels, width, height, reference, scale);
+            if(current < target) lo = scale;
+            else if(current > target) hi = scale;
+            else break;
+        }
+
+        const size_t count = size_t(width) * height;
+        for(size_t i = 0; i < count; i++){
+            uint8_t& a = pixels[i * 4 + 3];
+            a = static_cast<uint8_t>(std::min(255.0f, a * scale + 0.5f));
+        }
+    }
+
+    std::vector<level> build_chain(const uint8_t* pixels, int32_t width, int32_t height, int32_t channels, const options& opts){
+        std::vector<level> levels;
+        levels.reserve(level_count(width, height) - 1);
+
+        const uint8_t* src = pixels;
+        int32_t w = width, h = height;
+        while(w > 1 || h > 1){
+            level next{std::max(1, w / 2), std::max(1, h / 2), {}};
+            next.pixels.resize(size_t(next.width) * next.height * channels);
+
+            const int32_t tiles = (next.height + TILE_ROWS - 1) / TILE_ROWS;
+            if(opts.pool && tiles > 1 && next.width * next.height >= PARALLEL_TEXELS){
+                opts.pool->parallel_for(static_cast<uint32_t>(tiles), [&](uint32_t tile){
+                    const int32_t begin = static_cast<int32_t>(tile) * TILE_ROWS;
+                    downsample(src, w, h, channels, next.pixels.data(), opts.srgb, begin, std::min(next.height, begin + TILE_ROWS));
+                });
+            }
+            else downsample(src, w, h, channels, next.pixels.data(), opts.srgb, 0, next.height);
+
+            levels.push_back(std::move(next));
+            src = levels.back().pixels.data();
+            w = levels.back().width;
+            h = levels.back().height;
+        }
+
+        if(opts.preserve_coverage && channels == 4){
+            const float target = coverage(pixels, width, height, opts.alpha_reference);
+            for(auto& l : levels) scale_coverage(l.pixels.data(), l.width, l.height, opts.alpha_reference, target);
+        }
+
+        return levels;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace gapi{ class thread_pool; }
+
+namespace gapi::mip{
+
+    struct level{
+        int32_t width{0};
+        int32_t height{0};
+        std::vector<uint8_t> pixels{};
+    };
+
+    struct options{
+        bool srgb{false};
+        bool preserve_coverage{false};
+        float alpha_reference{0.5f};
+        thread_pool* pool{nullptr};
+    };
+
+    [[nodiscard]] inline uint32_t level_count(int32_t width, int32_t height){
+        uint32_t count = 1;
+        while(width > 1 || height > 1){
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+            count++;
+        }
+        return count;
+    }
+
+    // 2x2 box filter into a (width/2, height/2) image, writing destination rows [row_begin, row_end).
+    // With srgb the color channels are averaged in linear space; the alpha channel (2 or 4 channels) never is.
+    void downsample(const uint8_t* src, int32_t width, int32_t height, int32_t channels, uint8_t* dst, bool srgb, int32_t row_begin, int32_t row_end) noexcept;
+    void downsample_reference(const uint8_t* src, int32_t width, int32_t height, int32_t channels, uint8_t* dst, bool srgb) noexcept;
+
+    // Fraction of texels whose alpha * scale exceeds reference; 4 channel images only.
+    [[nodiscard]] float coverage(const uint8_t* pixels, int32_t width, int32_t height, float reference, float scale = 1.0f) noexcept;
+    void scale_coverage(uint8_t* pixels, int32_t width, int32_t height, float reference, float target) noexcept;
+
+    // Levels 1..N; the base image is not copied.
+    [[nodiscard]] std::vector<level> build_chain(const uint8_t* pixels, int32_t width, int32_t height, int32_t channels, const options& opts = {});
+}
+
+namespace gmip = gapi::mip;
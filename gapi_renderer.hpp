@@ -4,6 +4,79 @@
 
 namespace gapi::renderer{
 
+    struct draw_state{
+        const shader* program{nullptr};
+        const texture* tex{nullptr};
+        uint32_t slot{0};
+        uint8_t layer{0};
+        bool translucent{false};
+        float depth{0.0f};
+        buffer_range block{};
+        draw_range range{};
+    };
+
+    struct draw_packet{
+        uint64_t key{0};
+        uint32_t command{0};
+    };
+
+    struct draw_command{
+        const vertex_array* va{nullptr};
+        draw_state state{};
+    };
+
+    // Opaque:      layer:4 | 0 | program:10 | texture:12 | vao:13 | depth:24 (front to back)
+    // Translucent: layer:4 | 1 | depth:24 (back to front) | program:10 | texture:12 | vao:13
+    [[nodiscard]] inline uint64_t sort_key(const draw_state& state, uint32_t vao){
+        float depth = std::clamp(state.depth, 0.0f, 1.0f);
+        uint64_t quantized = static_cast<uint64_t>(depth * 0xFFFFFF);
+        uint64_t layer = static_cast<uint64_t>(state.layer & 0xF);
+        uint64_t program = state.program ? static_cast<uint64_t>(state.program->id() & 0x3FF) : 0;
+        uint64_t tex = state.tex ? static_cast<uint64_t>(state.tex->id() & 0xFFF) : 0;
+        uint64_t array = static_cast<uint64_t>(vao & 0x1FFF);
+        uint64_t material = (program << 25) | (tex << 13) | array;
+
+        if(state.translucent)
+            return (layer << 60) | (1ull << 59) | ((0xFFFFFF - quantized) << 35) | material;
+
+        return (layer << 60) | (material << 24) | quantized;
+    }
+
+    inline void radix_sort(std::vector<draw_packet>& packets, std::vector<draw_packet>& scratch){
+        const size_t count = packets.size();
+        if(count < 2) return;
+
+        std::array<std::array<uint32_t, 256>, 8> histograms{};
+        for(const auto& packet : packets){
+            for(size_t pass = 0; pass < 8; pass++)
+                histograms[pass][(packet.key >> (pass * 8)) & 0xFF]++;
+        }
+
+        scratch.resize(count);
+        draw_packet* src = packets.data();
+        draw_packet* dst = scratch.data();
+
+        for(size_t pass = 0; pass < 8; pass++){
+            auto& histogram = histograms[pass];
+            const size_t shift = pass * 8;
+            if(histogram[(src[0].key >> shift) & 0xFF] == count) continue;
+
+            uint32_t offset = 0;
+            for(auto& bucket : histogram){
+                uint32_t n = bucket;
+                bucket = offset;
+                offset += n;
+            }
+
+            for(size_t i = 0; i < count; i++)
+                dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+            std::swap(src, dst);
+        }
+
+        if(src != packets.data()) packets.swap(scratch);
+    }
+
     template<typename GApi>
     class gapi_render {
 
@@ -19,6 +92,7 @@ namespace gapi::renderer{
             }
 
             void clear(){
+                GAPI_PROFILE_ZONE("gapi_render::clear");
                 api->clear();
             }
 
@@ -26,18 +100,98 @@ namespace gapi::renderer{
                 api->clear_color(r, g, b, a);
             }
 
-            void submit(const std::shared_ptr<vertex_array>& va){
-                va->bind();
-                draw(va);
+            // Queued until flush(); everything referenced by the draw must outlive it,
+            // and uniform rings feeding state.block must be uploaded before flush().
+            void submit(const std::shared_ptr<vertex_array>& va, const draw_state& state = {}){
+                m_packets.push_back({sort_key(state, va->id()), static_cast<uint32_t>(m_commands.size())});
+                m_commands.push_back({va.get(), state});
+            }
+
+            void submit_instanced(const std::shared_ptr<vertex_array>& va, uint32_t instances, const draw_state& state = {}){
+                if(instances == 0) return;
+                draw_state instanced = state;
+                instanced.range.instances = instances;
+                submit(va, instanced);
             }
-    
+
+            void flush(){
+                GAPI_PROFILE_ZONE("gapi_render::flush");
+                radix_sort(m_packets, m_scratch);
+
+                const draw_command* current = nullptr;
+                const shader* program = nullptr;
+                const texture* tex = nullptr;
+                uint32_t slot = 0;
+                buffer_range block{};
+
+                for(const auto& packet : m_packets){
+                    const auto& command = m_commands[packet.command];
+                    const auto& state = command.state;
+
+                    if(current && batchable(*current, command)){
+                        m_batch.push_back(state.range);
+                        continue;
+                    }
+
+                    dispatch(current);
+
+                    if(state.program && state.program != program){
+                        state.program->bind();
+                        program = state.program;
+                    }
+
+                    if(state.tex && (state.tex != tex || state.slot != slot)){
+                        state.tex->bind(state.slot);
+                        tex = state.tex;
+                        slot = state.slot;
+                    }
+
+                    if(state.block.buffer && state.block != block){
+                        api->bind_range(state.block);
+                        block = state.block;
+                    }
+
+                    if(!current || command.va != current->va){
+                        command.va->bind();
+                    }
+
+                    current = &command;
+                    m_batch.push_back(state.range);
+                }
+
+                dispatch(current);
+                m_packets.clear();
+                m_commands.clear();
+            }
+
+            void end_frame(){
+                flush();
+                api->end_frame();
+            }
+
+            [[nodiscard]] inline size_t queued() const { return m_packets.size(); }
+            // Per-frame counters; collected only in GAPI_STATS builds.
+            [[nodiscard]] inline const auto& stats() const { return api->stats(); }
+
         private:
-            void draw(const std::shared_ptr<vertex_array>& va){
-                api->draw(va);
+            static bool batchable(const draw_command& a, const draw_command& b){
+                return a.va == b.va && a.state.program == b.state.program && a.state.tex == b.state.tex
+                    && a.state.slot == b.state.slot && a.state.block == b.state.block;
+            }
+
+            void dispatch(const draw_command* command){
+                if(m_batch.empty()) return;
+                if(m_batch.size() == 1) api->draw(*command->va, m_batch.front());
+                else api->draw_multi(*command->va, m_batch);
+                m_batch.clear();
             }
 
         private:
             std::shared_ptr<GApi> api;
+            std::vector<draw_packet> m_packets{};
+            std::vector<draw_packet> m_scratch{};
+            std::vector<draw_command> m_commands{};
+            std::vector<draw_range> m_batch{};
 
     };
 
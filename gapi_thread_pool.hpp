@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gapi{
+
+    class thread_pool{
+
+        public:
+            explicit thread_pool(uint32_t threads = 0){
+                if(threads == 0) threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+                m_workers.reserve(threads);
+                for(uint32_t i = 0; i < threads; i++) m_workers.emplace_back([this]{ run(); });
+            }
+
+            thread_pool(const thread_pool&) = delete;
+            thread_pool& operator=(const thread_pool&) = delete;
+
+            ~thread_pool(){
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_stop = true;
+                }
+                m_signal.notify_all();
+                for(auto& worker : m_workers) worker.join();
+            }
+
+            void submit(std::function<void()> job){
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_jobs.push_back(std::move(job));
+                }
+                m_signal.notify_one();
+            }
+
+            // The caller claims work too, so this completes even when every worker is busy.
+            void parallel_for(uint32_t count, const std::function<void(uint32_t)>& fn){
+                if(count == 0) return;
+
+                struct state{
+                    std::atomic<uint32_t> next{0};
+                    std::atomic<uint32_t> done{0};
+                    uint32_t count{0};
+                    const std::function<void(uint32_t)>* fn{nullptr};
+                    std::mutex mutex{};
+                    std::condition_variable finished{};
+
+                    void run(){
+                        for(uint32_t i; (i = next.fetch_add(1)) < count;){
+                            (*fn)(i);
+                            if(done.fetch_add(1) + 1 == count){
+                                std::lock_guard lock(mutex);
+                                finished.notify_all();
+                            }
+                        }
+                    }
+                };
+
+                auto shared = std::make_shared<state>();
+                shared->count = count;
+                shared->fn = &fn;
+
+                const uint32_t helpers = std::min<uint32_t>(count - 1, static_cast<uint32_t>(m_workers.size()));
+                for(uint32_t i = 0; i < helpers; i++) submit([shared]{ shared->run(); });
+
+                shared->run();
+                std::unique_lock lock(shared->mutex);
+                shared->finished.wait(lock, [&]{ return shared->done.load() == count; });
+            }
+
+            [[nodiscard]] inline size_t size() const { return m_workers.size(); }
+
+        private:
+            void run(){
+                for(;;){
+                    std::function<void()> job;
+                    {
+                        std::unique_lock lock(m_mutex);
+                        m_signal.wait(lock, [this]{ return m_stop || !m_jobs.empty(); });
+                        if(m_jobs.empty()) return;
+                        job = std::move(m_jobs.front());
+                        m_jobs.pop_front();
+                    }
+                    job();
+                }
+            }
+
+        private:
+            std::mutex m_mutex{};
+            std::condition_variable m_signal{};
+            std::deque<std::function<void()>> m_jobs{};
+            std::vector<std::thread> m_workers{};
+            bool m_stop{false};
+    };
+}
@@ -0,0 +1,246 @@
+#include "gapi_vertex_pack.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GAPI_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#define GAPI_SIMD_SSSE3
+#include <tmmintrin.h>
+#endif
+
+namespace gapi::pack{
+
+    static inline int32_t round_clamped(float v, float lo, float hi, float scale){
+        return static_cast<int32_t>(std::nearbyint(std::clamp(v, lo, hi) * scale));
+    }
+
+    uint16_t f32_to_f16(float v) noexcept {
+        constexpr uint32_t f32_infinity = 255u << 23;
+        constexpr uint32_t f16_max = (127u + 16u) << 23;
+        constexpr uint32_t denorm_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        const uint32_t sign = bits & 0x80000000u;
+        bits ^= sign;
+
+        uint16_t half;
+        if(bits >= f16_max){
+            half = bits > f32_infinity ? 0x7E00 : 0x7C00;
+        }
+        else if(bits < (113u << 23)){
+            float value, magic;
+            std::memcpy(&value, &bits, sizeof(value));
+            std::memcpy(&magic, &denorm_magic, sizeof(magic));
+            value += magic;
+            std::memcpy(&bits, &value, sizeof(bits));
+            half = static_cast<uint16_t>(bits - denorm_magic);
+        }
+        else{
+            const uint32_t mantissa_odd = (bits >> 13) & 1;
+            bits -= 112u << 23;
+            bits += 0xFFF + mantissa_odd;
+            half = static_cast<uint16_t>(bits >> 13);
+        }
+
+        return static_cast<uint16_t>(half | (sign >> 16));
+    }
+
+    uint32_t f32x4_to_snorm_10_10_10_2(float x, float y, float z, float w) noexcept {
+        const uint32_t px = static_cast<uint32_t>(round_clamped(x, -1.0f, 1.0f, 511.0f)) & 0x3FF;
+        const uint32_t py = static_cast<uint32_t>(round_clamped(y, -1.0f, 1.0f, 511.0f)) & 0x3FF;
+        const uint32_t pz = static_cast<uint32_t>(round_clamped(z, -1.0f, 1.0f, 511.0f)) & 0x3FF;
+        const uint32_t pw = static_cast<uint32_t>(round_clamped(w, -1.0f, 1.0f, 1.0f)) & 0x3;
+        return px | (py << 10) | (pz << 20) | (pw << 30);
+    }
+
+#ifdef GAPI_SIMD_SSE2
+    static inline __m128i f32_to_f16_sse2(__m128 v){
+        const __m128i sign_mask     = _mm_set1_epi32(static_cast<int32_t>(0x80000000u));
+        const __m128i f16_max       = _mm_set1_epi32((127 + 16) << 23);
+        const __m128i nan_bit       = _mm_set1_epi32(0x200);
+        const __m128i infinity      = _mm_set1_epi32(0x7C00);
+        const __m128i min_normal    = _mm_set1_epi32((127 - 14) << 23);
+        const __m128i denorm_magic  = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+        const __m128i normal_bias   = _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+
+        const __m128 sign = _mm_and_ps(_mm_castsi128_ps(sign_mask), v);
+        const __m128 absolute = _mm_xor_ps(v, sign);
+        const __m128i bits = _mm_castps_si128(absolute);
+
+        const __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+        const __m128i is_regular = _mm_cmpgt_epi32(f16_max, bits);
+        const __m128i special = _mm_or_si128(_mm_and_si128(is_nan, nan_bit), infinity);
+        const __m128i is_denormal = _mm_cmpgt_epi32(min_normal, bits);
+
+        const __m128 denormal_sum = _mm_add_ps(absolute, _mm_castsi128_ps(denorm_magic));
+        const __m128i denormal = _mm_sub_epi32(_mm_castps_si128(denormal_sum), denorm_magic);
+
+        const __m128i mantissa_odd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+        const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, normal_bias), mantissa_odd), 13);
+
+        const __m128i finite = _mm_or_si128(_mm_and_si128(denormal, is_denormal), _mm_andnot_si128(is_denormal, normal));
+        const __m128i merged = _mm_or_si128(_mm_and_si128(finite, is_regular), _mm_andnot_si128(is_regular, special));
+        return _mm_or_si128(merged, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+    }
+
+    static inline __m128 clamp_scale(const float* src, __m128 lo, __m128 hi, __m128 scale){
+        return _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), lo), hi), scale);
+    }
+#endif
+
+    void f32_to_f16(const float* src, uint16_t* dst, size_t count) noexcept {
+        size_t i = 0;
+#ifdef GAPI_SIMD_SSE2
+        for(; i + 8 <= count; i += 8){
+            __m128i a = f32_to_f16_sse2(_mm_loadu_ps(src + i));
+            __m128i b = f32_to_f16_sse2(_mm_loadu_ps(src + i + 4));
+            a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+            b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+        }
+#endif
+        for(; i < count; i++) dst[i] = f32_to_f16(src[i]);
+    }
+
+    void f32_to_unorm8(const float* src, uint8_t* dst, size_t count) noexcept {
+        size_t i = 0;
+#ifdef GAPI_SIMD_SSE2
+        const __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(255.0f);
+        for(; i + 16 <= count; i += 16){
+            __m128i a = _mm_cvtps_epi32(clamp_scale(src + i, lo, hi, scale));
+            __m128i b = _mm_cvtps_epi32(clamp_scale(src + i + 4, lo, hi, scale));
+            __m128i c = _mm_cvtps_epi32(clamp_scale(src + i + 8, lo, hi, scale));
+            __m128i d = _mm_cvtps_epi32(clamp_scale(src + i + 12, lo, hi, scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+        }
+#endif
+        for(; i < count; i++) dst[i] = static_cast<uint8_t>(round_clamped(src[i], 0.0f, 1.0f, 255.0f));
+    }
+
+    void f32_to_snorm8(const float* src, int8_t* dst, size_t count) noexcept {
+        size_t i = 0;
+#ifdef GAPI_SIMD_SSE2
+        const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(127.0f);
+        for(; i + 16 <= count; i += 16){
+            __m128i a = _mm_cvtps_epi32(clamp_scale(src + i, lo, hi, scale));
+            __m128i b = _mm_cvtps_epi32(clamp_scale(src + i + 4, lo, hi, scale));
+            __m128i c = _mm_cvtps_epi32(clamp_scale(src + i + 8, lo, hi, scale));
+            __m128i d = _mm_cvtps_epi32(clamp_scale(src + i + 12, lo, hi, scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+        }
+#endif
+        for(; i < count; i++) dst[i] = static_cast<int8_t>(round_clamped(src[i], -1.0f, 1.0f, 127.0f));
+    }
+
+    void f32_to_unorm16(const float* src, uint16_t* dst, size_t count) noexcept {
+        size_t i = 0;
+#ifdef GAPI_SIMD_SSE2
+        const __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(65535.0f);
+        const __m128i bias = _mm_set1_epi32(32768);
+        const __m128i flip = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+        for(; i + 8 <= count; i += 8){
+            __m128i a = _mm_sub_epi32(_mm_cvtps_epi32(clamp_scale(src + i, lo, hi, scale)), bias);
+            __m128i b = _mm_sub_epi32(_mm_cvtps_epi32(clamp_scale(src + i + 4, lo, hi, scale)), bias);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(_mm_packs_epi32(a, b), flip));
+        }
+#endif
+        for(; i < count; i++) dst[i] = static_cast<uint16_t>(round_clamped(src[i], 0.0f, 1.0f, 65535.0f));
+    }
+
+    void f32_to_snorm16(const float* src, int16_t* dst, size_t count) noexcept {
+        size_t i = 0;
+#ifdef GAPI_SIMD_SSE2
+        const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+        for(; i + 8 <= count; i += 8){
+            __m128i a = _mm_cvtps_epi32(clamp_scale(src + i, lo, hi, scale));
+            __m128i b = _mm_cvtps_epi32(clamp_scale(src + i + 4, lo, hi, scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+        }
+#endif
+        for(; i < count; i++) dst[i] = static_cast<int16_t>(round_clamped(src[i], -1.0f, 1.0f, 32767.0f));
+    }
+
+    void f32x3_to_snorm_10_10_10_2(const float* src, uint32_t* dst, size_t count) noexcept {
+        for(size_t i = 0; i < count; i++, src += 3)
+            dst[i] = f32x4_to_snorm_10_10_10_2(src[0], src[1], src[2], 0.0f);
+    }
+
+    void f32x4_to_snorm_10_10_10_2(const float* src, uint32_t* dst, size_t count) noexcept {
+        size_t i = 0;
+#ifdef GAPI_SIMD_SSE2
+        const __m128 lo = _mm_set1_ps(-1.0f), hi = _mm_set1_ps(1.0f), scale = _mm_set_ps(1.0f, 511.0f, 511.0f, 511.0f);
+        const __m128i mask = _mm_set_epi32(0x3, 0x3FF, 0x3FF, 0x3FF);
+        alignas(16) uint32_t lanes[4];
+        for(; i < count; i++, src += 4){
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_and_si128(_mm_cvtps_epi32(clamp_scale(src, lo, hi, scale)), mask));
+            dst[i] = lanes[0] | (lanes[1] << 10) | (lanes[2] << 20) | (lanes[3] << 30);
+        }
+#endif
+        for(; i < count; i++, src += 4)
+            dst[i] = f32x4_to_snorm_10_10_10_2(src[0], src[1], src[2], src[3]);
+    }
+
+#ifdef GAPI_SIMD_SSSE3
+    static void rgb8_expand_ssse3(const uint8_t* src, uint8_t* dst, size_t& i, size_t count, __m128i shuffle){
+        const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u));
+        for(; i + 6 <= count; i += 4){
+            __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+        }
+    }
+#endif
+
+    void rgb8_to_rgba8(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+        size_t i = 0;
+#ifdef GAPI_SIMD_SSSE3
+        rgb8_expand_ssse3(src, dst, i, count, _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1));
+#endif
+        for(; i < count; i++){
+            dst[i * 4 + 0] = src[i * 3 + 0];
+            dst[i * 4 + 1] = src[i * 3 + 1];
+            dst[i * 4 + 2] = src[i * 3 + 2];
+            dst[i * 4 + 3] = 0xFF;
+        }
+    }
+
+    void rgb8_to_bgra8(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+        size_t i = 0;
+#ifdef GAPI_SIMD_SSSE3
+        rgb8_expand_ssse3(src, dst, i, count, _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1));
+#endif
+        for(; i < count; i++){
+            dst[i * 4 + 0] = src[i * 3 + 2];
+            dst[i * 4 + 1] = src[i * 3 + 1];
+            dst[i * 4 + 2] = src[i * 3 + 0];
+            dst[i * 4 + 3] = 0xFF;
+        }
+    }
+
+    void rgba8_to_bgra8(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+        size_t i = 0;
+#ifdef GAPI_SIMD_SSE2
+        const __m128i keep = _mm_set1_epi32(static_cast<int32_t>(0xFF00FF00u));
+        const __m128i low = _mm_set1_epi32(0xFF);
+        for(; i + 4 <= count; i += 4){
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+            __m128i r = _mm_slli_epi32(_mm_and_si128(v, low), 16);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(v, 16), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_and_si128(v, keep), _mm_or_si128(r, b)));
+        }
+#endif
+        for(; i < count; i++){
+            const uint8_t r = src[i * 4 + 0], a = src[i * 4 + 3];
+            dst[i * 4 + 0] = src[i * 4 + 2];
+            dst[i * 4 + 1] = src[i * 4 + 1];
+            dst[i * 4 + 2] = r;
+            dst[i * 4 + 3] = a;
+        }
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace gapi::pack{
+
+    [[nodiscard]] uint16_t f32_to_f16(float v) noexcept;
+    [[nodiscard]] uint32_t f32x4_to_snorm_10_10_10_2(float x, float y, float z, float w) noexcept;
+
+    void f32_to_f16(const float* src, uint16_t* dst, size_t count) noexcept;
+    void f32_to_unorm8(const float* src, uint8_t* dst, size_t count) noexcept;
+    void f32_to_snorm8(const float* src, int8_t* dst, size_t count) noexcept;
+    void f32_to_unorm16(const float* src, uint16_t* dst, size_t count) noexcept;
+    void f32_to_snorm16(const float* src, int16_t* dst, size_t count) noexcept;
+    void f32x3_to_snorm_10_10_10_2(const float* src, uint32_t* dst, size_t count) noexcept;
+    void f32x4_to_snorm_10_10_10_2(const float* src, uint32_t* dst, size_t count) noexcept;
+
+    void rgb8_to_rgba8(const uint8_t* src, uint8_t* dst, size_t count) noexcept;
+    void rgb8_to_bgra8(const uint8_t* src, uint8_t* dst, size_t count) noexcept;
+    void rgba8_to_bgra8(const uint8_t* src, uint8_t* dst, size_t count) noexcept;
+}
+
+namespace gpack = gapi::pack;
@@ -0,0 +1,69 @@
+// Regression tests for the mesh optimization passes; no GL context needed.
+
+#include "gapi_mesh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+
+namespace{
+
+    int failures = 0;
+
+#define CHECK(cond) do{ if(!(cond)){ std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } }while(0)
+
+    using triangle = std::array<uint32_t, 3>;
+
+    std::vector<triangle> sorted_triangles(const uint32_t* indices, uint32_t index_count){
+        std::vector<triangle> triangles;
+        for(uint32_t i = 0; i + 2 < index_count; i += 3) triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    // A degenerate first triangle misses fewer than three times and used to leave the leading run unemitted.
+    void overdraw_degenerate_first_triangle(){
+        const float positions[] = {0, 0, 0,  1, 0, 0,  1, 1, 0,  0, 1, 0,  2, 0, 0};
+        const uint32_t indices[] = {0, 0, 1,  0, 1, 2,  0, 2, 3,  1, 4, 2};
+        constexpr uint32_t index_count = 12;
+
+        std::vector<uint32_t> dst(index_count, 0xFFFFFFFFu);
+        gmesh::optimize_overdraw(dst.data(), indices, index_count, positions, 5, 3 * sizeof(float));
+
+        CHECK(std::find(dst.begin(), dst.end(), 0xFFFFFFFFu) == dst.end());
+        CHECK(sorted_triangles(dst.data(), index_count) == sorted_triangles(indices, index_count));
+    }
+
+    void optimize_keeps_triangles(){
+        constexpr uint32_t grid = 8;
+        std::vector<float> positions;
+        for(uint32_t y = 0; y <= grid; y++){
+            for(uint32_t x = 0; x <= grid; x++){
+                positions.insert(positions.end(), {float(x), float(y), 0.0f});
+            }
+        }
+
+        std::vector<uint32_t> indices{0, 0, 1};
+        for(uint32_t y = 0; y < grid; y++){
+            for(uint32_t x = 0; x < grid; x++){
+                const uint32_t i = y * (grid + 1) + x;
+                indices.insert(indices.end(), {i, i + 1, i + grid + 2, i, i + grid + 2, i + grid + 1});
+            }
+        }
+
+        const auto count = static_cast<uint32_t>(indices.size());
+        auto mesh = gmesh::optimize(positions.data(), (grid + 1) * (grid + 1), 3 * sizeof(float), indices.data(), count);
+
+        CHECK(mesh.indices.size() == indices.size());
+        CHECK(mesh.vertex_count <= (grid + 1) * (grid + 1));
+        for(uint32_t index : mesh.indices) CHECK(index < mesh.vertex_count);
+    }
+}
+
+int main(){
+    overdraw_degenerate_first_triangle();
+    optimize_keeps_triangles();
+
+    if(failures) std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}